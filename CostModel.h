@@ -0,0 +1,537 @@
+//===----------------------------- CostModel.h ------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+// 
+// This file is distributed under the Università della Svizzera italiana (USI) 
+// Open Source License.
+//
+//===----------------------------------------------------------------------===
+//
+// The Area, Delay and SW cost of a DFG Node, in terms of its Opcode and
+// width only, so that it can be evaluated both on LLVM IR (Identify.h) and
+// on a RegionGraph snapshot (RegionGraph.h) without LLVM.
+//
+// The costs are dense tables indexed by Opcode, variant and width class,
+// filled from a built-in model or read from a file when the pass starts
+// (CostModel::load), so another technology point needs no rebuild. The few
+// costs that depend on more than the Opcode read Aux, with a rule per Opcode:
+//
+//   Switch          : Number of Cases. Area per Case, Delay per level of
+//                     the Case tree, ceil(log2(Cases)).
+//   ICmp            : 1 if it is an Equality comparison, 0 otherwise; picks
+//                     the "eq" or "rel" variant.
+//   Shl, LShr, AShr : 1 if the shift amount is a single value, 0 otherwise;
+//                     picks the "single" or "other" variant.
+//   Load, Store     : Primitive size in bits of the loaded/stored value,
+//                     not a cost.
+//
+// A cost model file holds one setting per line, # starts a comment:
+//
+//   builtin sys-aware|standalone     Start from a built-in model (sys-aware by default).
+//   ns-per-cycle <nSecs>             Clock period of the accelerator.
+//   call-overhead <Cycles>           Cost of invoking the accelerator.
+//   load-store-delay <nSecs>         Delay of each Load and Store of a BB; the
+//                                    Delay of a BB is at least their total
+//                                    (memory bound). 0, the default, for none.
+//   <Opcode>[.<variant>] <width> <delay nSecs> <SW cycles> <area LUTs> <area um^2> <marked 0|1>
+//
+// where width is * for all widths or one of 0 (unsized), 1, 8, 16, 32, 64
+// or wide, and applies to the widest of the result and operands of a Node.
+// CostModel::print writes a model in this format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef REGIONSEEKER_COSTMODEL_H
+#define REGIONSEEKER_COSTMODEL_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Identifies the built-in cost models and the rules above in the Region
+// cache of IdentifyRegions (-rs-cache-dir), together with the model in use.
+// Bump it whenever they change, cached results are then not used.
+#define COST_MODEL_VERSION      2
+
+// Opcodes of the cost model. The numbering is independent of the LLVM
+// version and is stored in RegionGraph snapshots, so only append to it.
+enum RGOpcode {
+    // Terminators
+    RG_Ret, RG_Br, RG_Switch, RG_IndirectBr, RG_Invoke, RG_Resume, RG_Unreachable,
+    // Binary operators
+    RG_Add, RG_FAdd, RG_Sub, RG_FSub, RG_Mul, RG_FMul, RG_UDiv, RG_SDiv, RG_FDiv, RG_URem, RG_SRem, RG_FRem,
+    // Logical operators
+    RG_Shl, RG_LShr, RG_AShr, RG_And, RG_Or, RG_Xor,
+    // Memory operators
+    RG_Alloca, RG_Load, RG_Store, RG_GetElementPtr, RG_Fence, RG_AtomicCmpXchg, RG_AtomicRMW,
+    // Casts
+    RG_Trunc, RG_ZExt, RG_SExt, RG_FPToUI, RG_FPToSI, RG_UIToFP, RG_SIToFP, RG_FPTrunc, RG_FPExt, RG_PtrToInt, RG_IntToPtr, RG_BitCast,
+    // Other operators
+    RG_ICmp, RG_FCmp, RG_PHI, RG_Call, RG_Select, RG_ExtractElement, RG_InsertElement, RG_ShuffleVector, RG_ExtractValue, RG_InsertValue, RG_LandingPad,
+    RG_Other,            // Everything else, e.g. VAArg and UserOp1.
+    RG_NumOpcodes
+};
+
+namespace {
+
+  const char *rgOpcodeName(RGOpcode Opcode)
+  {
+    static const char *const Names[RG_NumOpcodes] = {
+      "Ret", "Br", "Switch", "IndirectBr", "Invoke", "Resume", "Unreachable",
+      "Add", "FAdd", "Sub", "FSub", "Mul", "FMul", "UDiv", "SDiv", "FDiv", "URem", "SRem", "FRem",
+      "Shl", "LShr", "AShr", "And", "Or", "Xor",
+      "Alloca", "Load", "Store", "GetElementPtr", "Fence", "AtomicCmpXchg", "AtomicRMW",
+      "Trunc", "ZExt", "SExt", "FPToUI", "FPToSI", "UIToFP", "SIToFP", "FPTrunc", "FPExt", "PtrToInt", "IntToPtr", "BitCast",
+      "ICmp", "FCmp", "PHI", "Call", "Select", "ExtractElement", "InsertElement", "ShuffleVector", "ExtractValue", "InsertValue", "LandingPad",
+      "Other"
+    };
+
+    return Opcode < RG_NumOpcodes ? Names[Opcode] : "Invalid";
+  }
+
+  // Width classes of a DFG Node, by the widest of its result and operands.
+  enum RGWidthClass {
+    RGW_None, RGW_1, RGW_8, RGW_16, RGW_32, RGW_64, RGW_Wide,
+    RGW_NumClasses
+  };
+
+  RGWidthClass rgWidthClass(uint64_t Bits)
+  {
+    if (Bits == 0)  return RGW_None;
+    if (Bits == 1)  return RGW_1;
+    if (Bits <= 8)  return RGW_8;
+    if (Bits <= 16) return RGW_16;
+    if (Bits <= 32) return RGW_32;
+    if (Bits <= 64) return RGW_64;
+    return RGW_Wide;
+  }
+
+  const char *rgWidthClassName(unsigned Class)
+  {
+    static const char *const Names[RGW_NumClasses] = { "0", "1", "8", "16", "32", "64", "wide" };
+    return Names[Class];
+  }
+
+  // How Aux enters the cost of an Opcode.
+  enum RGAuxRule {
+    RGA_None,             // Not at all.
+    RGA_Variant,          // Aux != 0 selects variant 1 of the costs.
+    RGA_PerCase           // Area times Aux, Delay times ceil(log2(Aux)).
+  };
+
+  RGAuxRule rgAuxRule(RGOpcode Opcode)
+  {
+    switch (Opcode) {
+    case RG_Switch:
+      return RGA_PerCase;
+    case RG_ICmp: case RG_Shl: case RG_LShr: case RG_AShr:
+      return RGA_Variant;
+    default:
+      return RGA_None;
+    }
+  }
+
+  // Names of the variants of an RGA_Variant Opcode, in the cost model file.
+  const char *rgVariantName(RGOpcode Opcode, unsigned Variant)
+  {
+    if (Opcode == RG_ICmp)
+      return Variant ? "eq" : "rel";
+
+    return Variant ? "single" : "other";
+  }
+
+  // Bins of the cost tables, Opcode, variant and width class, which are also
+  // the bins of the opcode histograms of RegionGraph.h (BlockHistogramTable).
+  // Opcodes without variants count their Nodes in variant 0, per-Case ones
+  // their Cases in variant 1 as well.
+  const unsigned RG_NumCostBins = RG_NumOpcodes * 2 * RGW_NumClasses;
+
+  unsigned rgCostBin(RGOpcode Opcode, unsigned Variant, unsigned WidthClass)
+  {
+    return (Opcode * 2 + Variant) * RGW_NumClasses + WidthClass;
+  }
+
+  // Cost of one DFG Node.
+  struct RGNodeCost {
+    double   Delay;       // HW Delay in nSecs.
+    double   SWCycles;    // SW Delay in Cycles.
+    unsigned Area;        // Area in LUTs.
+    unsigned AreaUMSq;    // Area in um^2.
+    bool     Marked;      // Marked or forbidden Node, it cannot be accelerated.
+  };
+
+  // A row of a built-in model: the costs of an Opcode (variant) at any width.
+  struct RGBuiltinCost {
+    RGOpcode Opcode;
+    unsigned Variant;
+    bool     Marked;
+    double   SWCycles;
+    unsigned AreaUMSq;
+    unsigned SysAwareArea;   double SysAwareDelay;    // RegionSeeker, system aware.
+    unsigned StandaloneArea; double StandaloneDelay;  // Standalone accelerators.
+  };
+
+  // The built-in models. Opcodes that are not listed, e.g. RG_Other, are
+  // marked and cost nothing. FMul costs as much as UDiv in SW.
+  const RGBuiltinCost RGBuiltinCosts[] = {
+    //                       Marked SW    um^2   SysAware      Standalone
+    { RG_Ret,            0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Br,             0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Switch,         0, true,  1,       40,   16,  4.3,     33, 0.23 },  // Per Case / level.
+    { RG_IndirectBr,     0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Invoke,         0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Resume,         0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Unreachable,    0, true,  0,        0,    0,  0,        0, 0    },
+    { RG_Add,            0, false, 1,      160,   32,  5.3,     33, 0.92 },
+    { RG_FAdd,           0, false, 2,      160,   32,  5.3,     33, 0.92 },
+    { RG_Sub,            0, false, 1,      173,   32,  5.3,     33, 0.92 },
+    { RG_FSub,           0, false, 2,      173,   32,  5.3,     33, 0.92 },
+    { RG_Mul,            0, false, 1,     2275,    0,  8.5,    618, 1    },
+    { RG_FMul,           0, false, 6,     2275,    0,  8.5,    618, 1    },
+    { RG_UDiv,           0, false, 6,    16114,  320,  49.5,  1056, 3.76 },
+    { RG_SDiv,           0, false, 6,    16114,  320,  53,    1185, 3.76 },
+    { RG_FDiv,           0, false, 12,   16114,  320,  53,    1185, 3.76 },
+    { RG_URem,           0, false, 6,    17298,  320,  52.6,  1312, 4.04 },
+    { RG_SRem,           0, false, 6,    17298,  320,  55.4,  1312, 4.04 },
+    { RG_FRem,           0, false, 12,   17298,  320,  55.4,  1312, 4.04 },
+    { RG_Shl,            0, false, 1,      187,   79,  5.5,    103, 0.71 },
+    { RG_Shl,            1, false, 0,        0,    0,  0,        0, 0    },  // Shift by a single value.
+    { RG_LShr,           0, false, 1,      187,   79,  5.5,    101, 0.73 },
+    { RG_LShr,           1, false, 0,        0,    0,  0,        0, 0    },
+    { RG_AShr,           0, false, 1,      311,   99,  6.6,    145, 0.65 },
+    { RG_AShr,           1, false, 0,        0,    0,  0,        0, 0    },
+    { RG_And,            0, false, 1,       26,   32,  4.3,     33, 0.02 },
+    { RG_Or,             0, false, 1,       26,   32,  4.3,     33, 0.03 },
+    { RG_Xor,            0, false, 1,       40,   32,  4.3,     33, 0.03 },
+    { RG_Alloca,         0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Load,           0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Store,          0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_GetElementPtr,  0, true,  0,        0,    0,  0,        0, 0    },
+    { RG_Fence,          0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_AtomicCmpXchg,  0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_AtomicRMW,      0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_ICmp,           0, false, 1,       78,   16,  0,       17, 0    },  // Relational.
+    { RG_ICmp,           1, false, 1,       50,   11,  5,       12, 0.15 },  // Equality.
+    { RG_FCmp,           0, false, 1,       78,   16,  5,       17, 0.15 },
+    { RG_PHI,            0, true,  1,       40,   16,  4.3,     33, 0.23 },
+    { RG_Call,           0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_Select,         0, false, 1,       40,   16,  4.3,     33, 0.23 },
+    { RG_ExtractElement, 0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_InsertElement,  0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_ShuffleVector,  0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_ExtractValue,   0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_InsertValue,    0, true,  1,        0,    0,  0,        0, 0    },
+    { RG_LandingPad,     0, true,  1,        0,    0,  0,        0, 0    },
+  };
+
+  // The cost model: a clock, an invocation overhead and the cost of every
+  // Opcode, variant and width class. Looking a cost up is a table read.
+  class CostModel {
+
+    RGNodeCost Costs[RG_NumOpcodes][2][RGW_NumClasses];
+
+    void setCosts(RGOpcode Opcode, unsigned Variant, int WidthClass, const RGNodeCost &Cost) {
+
+      for (unsigned W = 0; W < RGW_NumClasses; W++)
+        if (WidthClass < 0 || static_cast<unsigned>(WidthClass) == W)
+          Costs[Opcode][Variant][W] = Cost;
+
+      // Opcodes without variants read variant 0 only, keep both the same.
+      if (rgAuxRule(Opcode) != RGA_Variant)
+        for (unsigned W = 0; W < RGW_NumClasses; W++)
+          Costs[Opcode][1][W] = Costs[Opcode][0][W];
+    }
+
+    // @return  false, with Error set, if Line is not a valid setting.
+    bool parseLine(const std::string &Line, std::string &Error) {
+
+      std::istringstream In(Line.substr(0, Line.find('#')));
+      std::string Key;
+
+      if (!(In >> Key))
+        return true;
+
+      if (Key == "builtin") {
+        std::string Name;
+        if (!(In >> Name) || !setBuiltin(Name)) {
+          Error = "unknown built-in model '" + Name + "'";
+          return false;
+        }
+      }
+      else if (Key == "ns-per-cycle") {
+        if (!(In >> NsecsPerCycle) || NsecsPerCycle <= 0) {
+          Error = "ns-per-cycle needs a positive number";
+          return false;
+        }
+      }
+      else if (Key == "call-overhead") {
+        if (!(In >> CallOverhead)) {
+          Error = "call-overhead needs a number";
+          return false;
+        }
+      }
+      else if (Key == "load-store-delay") {
+        if (!(In >> LoadStoreDelay) || LoadStoreDelay < 0) {
+          Error = "load-store-delay needs a number, 0 or more";
+          return false;
+        }
+      }
+      else {
+        std::string OpcodeName = Key.substr(0, Key.find('.'));
+        std::string VariantName = Key.find('.') == std::string::npos ? "" : Key.substr(Key.find('.') + 1);
+        unsigned Opcode = 0, Variant = 0;
+
+        while (Opcode < RG_NumOpcodes && OpcodeName != rgOpcodeName(static_cast<RGOpcode>(Opcode)))
+          Opcode++;
+
+        if (Opcode == RG_NumOpcodes) {
+          Error = "unknown opcode '" + OpcodeName + "'";
+          return false;
+        }
+
+        if (!VariantName.empty()) {
+          while (Variant < 2 && (rgAuxRule(static_cast<RGOpcode>(Opcode)) != RGA_Variant ||
+                                 VariantName != rgVariantName(static_cast<RGOpcode>(Opcode), Variant)))
+            Variant++;
+
+          if (Variant == 2) {
+            Error = "unknown variant '" + Key + "'";
+            return false;
+          }
+        }
+
+        std::string Width;
+        RGNodeCost Cost;
+        int Marked = 0;
+
+        if (!(In >> Width >> Cost.Delay >> Cost.SWCycles >> Cost.Area >> Cost.AreaUMSq >> Marked)) {
+          Error = "expected <width> <delay> <SW cycles> <area> <area um^2> <marked> after '" + Key + "'";
+          return false;
+        }
+
+        int WidthClass = 0;
+
+        if (Width == "*")
+          WidthClass = -1;
+        else
+          while (WidthClass < RGW_NumClasses && Width != rgWidthClassName(WidthClass))
+            WidthClass++;
+
+        if (WidthClass == RGW_NumClasses) {
+          Error = "unknown width '" + Width + "'";
+          return false;
+        }
+
+        Cost.Marked = Marked != 0;
+        setCosts(static_cast<RGOpcode>(Opcode), Variant, WidthClass, Cost);
+      }
+
+      std::string Extra;
+      if (In >> Extra) {
+        Error = "unexpected '" + Extra + "'";
+        return false;
+      }
+
+      return true;
+    }
+
+  public:
+    double NsecsPerCycle;       // nSecs per Cycle of the accelerator.
+    double CallOverhead;        // Cycles per invocation of the accelerator.
+    double LoadStoreDelay;      // nSecs per Load and Store if BBs are memory bound, 0 if not.
+
+    CostModel() { setBuiltin("sys-aware"); }
+
+    // Reset to the built-in model Name: "sys-aware" (RegionSeeker, the
+    // default) or "standalone", both at 100 MHz.
+    //
+    // @return  false if there is no such model.
+    bool setBuiltin(const std::string &Name) {
+
+      if (Name != "sys-aware" && Name != "standalone")
+        return false;
+
+      bool SysAware = Name == "sys-aware";
+      RGNodeCost Free = { 0, 0, 0, 0, true };
+
+      NsecsPerCycle = 10;       // 100 MHz
+      CallOverhead = 10;
+      LoadStoreDelay = 0;       // 10 in the memory bound setup.
+
+      for (unsigned Opcode = 0; Opcode < RG_NumOpcodes; Opcode++)
+        for (unsigned Variant = 0; Variant < 2; Variant++)
+          setCosts(static_cast<RGOpcode>(Opcode), Variant, -1, Free);
+
+      for (unsigned i = 0; i < sizeof(RGBuiltinCosts) / sizeof(RGBuiltinCosts[0]); i++) {
+
+        const RGBuiltinCost &B = RGBuiltinCosts[i];
+        RGNodeCost Cost = { SysAware ? B.SysAwareDelay : B.StandaloneDelay, B.SWCycles,
+                            SysAware ? B.SysAwareArea : B.StandaloneArea, B.AreaUMSq, B.Marked };
+
+        setCosts(B.Opcode, B.Variant, -1, Cost);
+      }
+
+      return true;
+    }
+
+    // Apply the settings of the cost model file Path, see the top of this file.
+    //
+    // @return  false, with Error set, if it cannot be read or is malformed.
+    bool load(const std::string &Path, std::string &Error) {
+
+      std::ifstream File(Path.c_str());
+
+      if (!File) {
+        Error = "cannot read '" + Path + "'";
+        return false;
+      }
+
+      std::string Line;
+
+      for (unsigned N = 1; std::getline(File, Line); N++)
+        if (!parseLine(Line, Error)) {
+          Error = Path + ":" + std::to_string(N) + ": " + Error;
+          return false;
+        }
+
+      return true;
+    }
+
+    // Set the model from Spec, <name|file>[:<ns-per-cycle>[:<call-overhead>]]:
+    // a built-in model or a cost model file, then optionally another clock
+    // period and invocation overhead, e.g. "sys-aware:0.83:20".
+    //
+    // @return  false, with Error set, if Spec is not a valid model.
+    bool configure(const std::string &Spec, std::string &Error) {
+
+      std::string Name = Spec.substr(0, Spec.find(':'));
+      std::string Overrides = Name.size() < Spec.size() ? Spec.substr(Name.size() + 1) : "";
+
+      *this = CostModel();
+
+      if (!setBuiltin(Name) && !load(Name, Error))
+        return false;
+
+      if (Overrides.empty())
+        return true;
+
+      std::string Clock = Overrides.substr(0, Overrides.find(':'));
+      std::string Overhead = Clock.size() < Overrides.size() ? Overrides.substr(Clock.size() + 1) : "";
+
+      if (!parseLine("ns-per-cycle " + Clock, Error) ||
+          (!Overhead.empty() && !parseLine("call-overhead " + Overhead, Error))) {
+        Error = "'" + Spec + "': " + Error;
+        return false;
+      }
+
+      return true;
+    }
+
+    // Write the whole model in the format of load, one line per Opcode and
+    // variant unless its costs differ by width.
+    void print(std::ostream &OS) const {
+
+      OS.precision(15);
+      OS << "ns-per-cycle " << NsecsPerCycle << "\n";
+      OS << "call-overhead " << CallOverhead << "\n";
+      OS << "load-store-delay " << LoadStoreDelay << "\n";
+      OS << "# Opcode[.variant] width delay SW-cycles area area-um^2 marked\n";
+
+      for (unsigned Opcode = 0; Opcode < RG_NumOpcodes; Opcode++) {
+
+        RGOpcode Op = static_cast<RGOpcode>(Opcode);
+
+        for (unsigned Variant = 0; Variant < (rgAuxRule(Op) == RGA_Variant ? 2u : 1u); Variant++) {
+
+          const RGNodeCost *Row = Costs[Opcode][Variant];
+          bool SameWidths = true;
+
+          for (unsigned W = 1; W < RGW_NumClasses; W++)
+            SameWidths = SameWidths && Row[W].Delay == Row[0].Delay && Row[W].SWCycles == Row[0].SWCycles &&
+                         Row[W].Area == Row[0].Area && Row[W].AreaUMSq == Row[0].AreaUMSq &&
+                         Row[W].Marked == Row[0].Marked;
+
+          for (unsigned W = 0; W < (SameWidths ? 1u : unsigned(RGW_NumClasses)); W++) {
+
+            OS << rgOpcodeName(Op);
+            if (rgAuxRule(Op) == RGA_Variant)
+              OS << "." << rgVariantName(Op, Variant);
+            OS << " " << (SameWidths ? "*" : rgWidthClassName(W)) << " " << Row[W].Delay << " "
+               << Row[W].SWCycles << " " << Row[W].Area << " " << Row[W].AreaUMSq << " " << Row[W].Marked << "\n";
+          }
+        }
+      }
+    }
+
+    // The Area, SW Cycles and unmarked Node count of every bin of rgCostBin,
+    // so that their totals over a BB are dot products with its histogram.
+    void getCostVectors(std::vector<float> &Area, std::vector<float> &SWCycles, std::vector<float> &Good) const {
+
+      Area.assign(RG_NumCostBins, 0);
+      SWCycles.assign(RG_NumCostBins, 0);
+      Good.assign(RG_NumCostBins, 0);
+
+      for (unsigned Opcode = 0; Opcode < RG_NumOpcodes; Opcode++)
+        for (unsigned W = 0; W < RGW_NumClasses; W++)
+          for (unsigned Variant = 0; Variant < 2; Variant++) {
+
+            RGAuxRule Rule = rgAuxRule(static_cast<RGOpcode>(Opcode));
+            const RGNodeCost &C = Costs[Opcode][Variant][W];
+            unsigned Bin = rgCostBin(static_cast<RGOpcode>(Opcode), Variant, W);
+
+            if (Rule == RGA_Variant || Variant == 0) {
+              SWCycles[Bin] = C.SWCycles;
+              Good[Bin] = !C.Marked;
+            }
+
+            if (Rule == RGA_PerCase ? Variant == 1 : Rule == RGA_Variant || Variant == 0)
+              Area[Bin] = C.Area;
+          }
+    }
+
+    const RGNodeCost &get(RGOpcode Opcode, unsigned Aux, uint64_t Bits) const {
+
+      return Costs[Opcode][Aux != 0][rgWidthClass(Bits)];
+    }
+
+    //marked or forbidden nodes
+    bool isMarked(RGOpcode Opcode, unsigned Aux, uint64_t Bits) const {
+
+      return get(Opcode, Aux, Bits).Marked;
+    }
+
+    //Area Estimation for each DFG Node/Istruction in LUTs
+    unsigned int getAreaEstim(RGOpcode Opcode, unsigned Aux, uint64_t Bits) const {
+
+      unsigned int Area = get(Opcode, Aux, Bits).Area;
+      return rgAuxRule(Opcode) == RGA_PerCase ? Area * Aux : Area;
+    }
+
+    //Area Estimation for each DFG Node/Istruction in μM^2.
+    unsigned int getAreaEstimInUMSq(RGOpcode Opcode, unsigned Aux, uint64_t Bits) const {
+
+      unsigned int Area = get(Opcode, Aux, Bits).AreaUMSq;
+      return rgAuxRule(Opcode) == RGA_PerCase ? Area * Aux : Area;
+    }
+
+    //  Delay HW Estimation for each DFG Node/Istruction in nSecs.
+    float getDelayEstim(RGOpcode Opcode, unsigned Aux, uint64_t Bits) const {
+
+      double Delay = get(Opcode, Aux, Bits).Delay;
+      return rgAuxRule(Opcode) == RGA_PerCase ? ceil(log2(Aux)) * Delay : Delay;
+    }
+
+    //  Delay SW Estimation for each DFG Node/Istruction in Cycles.
+    float getCycleSWDelayEstim(RGOpcode Opcode, unsigned Aux, uint64_t Bits) const {
+
+      return get(Opcode, Aux, Bits).SWCycles;
+    }
+  };
+
+} // End of anonymous namespace
+
+#endif // REGIONSEEKER_COSTMODEL_H
@@ -16,6 +16,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/BasicBlock.h"
@@ -35,1031 +36,960 @@
 #include "llvm/Pass.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Transforms/Utils/Local.h"
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
 #include "llvm/IR/CFG.h"
 #include "../Identify.h" // Header file for all 3 passes. (IdentifyRegions, IdentifyBbs, IdentifyFunctions)
+#include "../RegionResults.h"
+#include "../RegionGraph.h"
 #include "IdentifyRegions.h"
 
 #define DEBUG_TYPE "IdentifyRegions"
 
-#define User_Input    100  // # of Scalar Instructions (Operands)
-#define User_Output   100 // # of Scalar Instructions (Operands)
-
-
 STATISTIC(RegionCounter, "The # of Regions Identified");
+STATISTIC(RejectedNoExit,  "The # of Regions rejected as the whole Function");
+STATISTIC(RejectedCall,    "The # of Regions rejected for containing calls");
+STATISTIC(RejectedBlocks,  "The # of Regions rejected for having more BBs than -rs-max-blocks");
+STATISTIC(RejectedNodes,   "The # of Regions rejected for having more DFG Nodes than -rs-max-nodes");
+STATISTIC(RejectedFreq,    "The # of Regions rejected for being entered less often than -rs-min-freq");
+STATISTIC(RejectedInputs,  "The # of Regions rejected for having more Inputs than -rs-max-inputs");
+STATISTIC(RejectedOutputs, "The # of Regions rejected for having more Outputs than -rs-max-outputs");
+STATISTIC(SkippedRegions,  "The # of Regions not costed as -rs-time-budget ran out");
+STATISTIC(PartialFunctions, "The # of Functions not costed in full, see -rs-time-budget and -rs-coverage");
+STATISTIC(CacheHits,     "The # of Functions whose Regions were read from the cache");
+STATISTIC(CacheMisses,   "The # of Functions costed and added to the cache");
+STATISTIC(ScratchAllocations, "The # of heap allocations of the scratch arenas of the Region checks and costing");
 
 using namespace llvm;
 
-namespace {
+static cl::opt<unsigned> RegionMinDepth("rs-min-depth", cl::init(0),
+  cl::desc("Only analyze Regions at this depth of the Region tree or deeper"));
 
-  struct IdentifyRegions : public FunctionPass {
-    static char ID; // Pass Identification, replacement for typeid
+static cl::opt<unsigned> RegionMaxDepth("rs-max-depth", cl::init(~0U),
+  cl::desc("Only analyze Regions at this depth of the Region tree or shallower"));
 
-    IdentifyRegions() : FunctionPass(ID) {}
+static cl::opt<unsigned> RegionMaxBlocks("rs-max-blocks", cl::init(~0U),
+  cl::desc("Only accelerate Regions of at most this many BBs"));
 
-    bool runOnFunction(Function &F) override {
+static cl::opt<unsigned> RegionMaxNodes("rs-max-nodes", cl::init(~0U),
+  cl::desc("Only accelerate Regions of at most this many DFG Nodes"));
 
-      std::vector<Region *> Region_list;
-      std::vector<BasicBlock*> BB_list;
-      std::vector<unsigned int> Goodness_list, Density_list;
-      Region_list.clear();
-      Goodness_list.clear();
-      Density_list.clear();
-      BB_list.clear();
+static cl::opt<double> RegionMinFreq("rs-min-freq", cl::init(0),
+  cl::desc("Only accelerate Regions entered at least this many times"));
 
-      RegionInfo *RI = &getAnalysis<RegionInfoPass>().getRegionInfo();
+static cl::opt<unsigned> RegionMaxInputs("rs-max-inputs", cl::init(100),
+  cl::desc("Only accelerate Regions with at most this many Inputs (Operands)"));
 
-      errs() << "\n\nFunction Name is : " << F.getName() << "\n";
+static cl::opt<unsigned> RegionMaxOutputs("rs-max-outputs", cl::init(100),
+  cl::desc("Only accelerate Regions with at most this many Outputs (Instructions)"));
 
-      // Iterate over Regions in the Function
-      for(Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+static cl::opt<RSVerbosityLevel, true> Verbosity("rs-verbosity", cl::location(RSVerbosity), cl::init(RSV_Region),
+  cl::desc("Diagnostic output of the pass on stderr"),
+  cl::values(clEnumValN(RSV_Quiet,   "quiet",   "No output, only the Region files"),
+             clEnumValN(RSV_Summary, "summary", "The valid Regions of each Function"),
+             clEnumValN(RSV_Region,  "region",  "The analysis of each Region (default)"),
+             clEnumValN(RSV_Trace,   "trace",   "The steps of the cost estimation"),
+             clEnumValEnd));
 
-        if (Region *R = RI->getRegionFor(&*BB)) {
+static cl::opt<std::string> OutputDir("rs-output-dir", cl::init("."),
+  cl::desc("Directory the Region files are written to"), cl::value_desc("dir"));
 
-          if (isRegionValid(R) && find_region(Region_list, R) == -1) {
-            Region_list.push_back(R);
-            Goodness_list.push_back(getGoodnessOfRegion(R));
-            Density_list.push_back(getDensityOfRegion(R));
+static cl::opt<std::string> OutputPrefix("rs-output-prefix", cl::init(""),
+  cl::desc("Prefix of the names of the Region files"), cl::value_desc("prefix"));
 
-            RegionAnalysis(R);
-          }
-        }
-	
-	// Print the DFG Graphs.
-	//DFGPrinterBB(&*BB); // Activate to print the DFG graphs.
+static cl::opt<bool> SaveSnapshots("rs-save-snapshots", cl::init(false),
+  cl::desc("Also save the RegionGraph of every Function to Snapshots.rg, to be costed offline by RegionCost"));
 
-      }
+static cl::opt<unsigned> Threads("rs-threads", cl::init(1),
+  cl::desc("Number of threads costing the Regions, 0 for one per core"));
 
-      errs() << "   Valid Regions are : " << "\n" ;
-      for (int i=0; i< Region_list.size(); i++)
-        errs() << " Goodness " << Goodness_list[i] << " Density " << Density_list[i] 
-            << "   Reg_Name " << Region_list[i]->getEntry()->getName() << " => " << Region_list[i]->getExit()->getName()
-	    //Region_list[i]->getNameStr() 
-	    << "\n" ;
+static cl::opt<std::string> CostModelFile("rs-cost-model", cl::init("sys-aware"),
+  cl::desc("Cost model: a built-in one, sys-aware or standalone, or a cost model file (see CostModel.h), "
+           "optionally with another clock period and invocation overhead"),
+  cl::value_desc("name|file[:ns-per-cycle[:call-overhead]]"));
 
-      return false;
-    }
-    
+static cl::list<std::string> ConfigSpecs("rs-configs", cl::CommaSeparated,
+  cl::desc("Also write the Speedup of every Region under each of these cost models to Regions_configs.txt, "
+           "one column each, in the format of -rs-cost-model"),
+  cl::value_desc("name|file[:ns-per-cycle[:call-overhead]],..."));
 
-    void printBBRegionList(Region *R, std::vector<BasicBlock *> BB_list) {
+static cl::opt<std::string> TimeBudget("rs-time-budget", cl::init(""),
+  cl::desc("Cost the hottest Functions and Regions first and none after this wall-clock time, "
+           "e.g. 5s or 500ms, none if empty"),
+  cl::value_desc("time"));
 
-     // errs() << "BB_list " ; 
+static cl::opt<double> Coverage("rs-coverage", cl::init(1),
+  cl::desc("Only cost the hottest Functions that hold this fraction of the dynamic Instructions of the Module"));
 
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
+static cl::opt<std::string> CacheDir("rs-cache-dir", cl::init(""),
+  cl::desc("Directory of the cache of costed Functions, none if empty"), cl::value_desc("dir"));
 
-        //errs() << find_bb(BB_list, *BB) << " ";
+static cl::opt<bool> CacheInvalidate("rs-cache-invalidate", cl::init(false),
+  cl::desc("Cost every Function again and replace what the cache holds for it"));
 
-        myfile.open ("Regions.txt", std::ofstream::out | std::ofstream::app); 
-        myfile << find_bb(BB_list, *BB)  << "," ;
-        myfile.close();
+namespace {
 
+  // The Regions of one Function and everything the pass writes for them.
+  //
+  // Graph and LoopInfoText are filled in runOnFunction, where the LLVM
+  // analyses of the Function are available. The Regions are then costed on
+  // any thread and the output is kept here until every Function before this
+  // one is written, so the Region files and stderr do not depend on the
+  // number of threads.
+  struct FunctionRegions {
+
+    RegionGraph Graph;
+    std::vector<std::string> LoopInfoText; // Loop and Array analysis of each Region, printed after its Costs.
+
+    // Output for stderr, Regions.txt, Regions_raw.txt, Region_info_latex.txt and Regions_configs.txt.
+    std::string Diagnostics, Text, Raw, Latex, Configs;
+    std::vector<RegionResultRow> Rows; // Parent is an index in Rows, the Names are in RowNames.
+    std::vector<std::string> RowNames;
+
+    uint64_t Key;     // Of the cache, see getCacheKey.
+    bool FromCache;   // The output was read from the cache rather than costed.
+    double Weight;    // Dynamic Instructions, the order of hot-first costing.
+    bool Partial;     // Not all of its Regions were costed, see -rs-time-budget and -rs-coverage.
+    std::atomic<bool> Costed;
+
+    FunctionRegions() : Key(0), FromCache(false), Weight(0), Partial(false), Costed(false) {}
+  };
 
-      }
+  // What RegionCoster::run costs.
+  struct CostingOptions {
 
-      //errs() << "\n" ; 
+    unsigned MinDepth, MaxDepth;
+    RegionLimits Limits;
+    bool HasDeadline;     // Cost the Regions hottest first, and none after Deadline.
+    std::chrono::steady_clock::time_point Deadline;
 
-      myfile.open ("Regions.txt", std::ofstream::out | std::ofstream::app); 
-      myfile << "\n" ;
-      myfile.close();
-      
-    }
+    CostingOptions() : MinDepth(0), MaxDepth(~0U), HasDeadline(false) {}
+  };
 
-    virtual unsigned int getGoodnessOfRegion(Region *R) {
+  // Costs the Regions of a FunctionRegions. It only reads the Graph and
+  // writes the output of its own FunctionRegions, so different Functions can
+  // be costed concurrently.
+  class RegionCoster {
 
-      unsigned int DFGNodesRegion = 0;
-      unsigned int GoodDFGNodesRegion = 0;
-      unsigned int GoodnessRegion = 0;
+    FunctionRegions &FR;
+    const RegionGraph &Graph;
+    BlockMetricsTable BBMetrics; // Per BB metrics of the Function, shared by all its Regions.
+    RegionMetricsTree RegMetrics; // Per Region metrics of the Function.
+    ConfigMetricsTable ConfigMetrics; // Per BB costs under each of the -rs-configs models.
+    std::vector<int32_t> RegionRows; // Row in FR.Rows of each Region, -1 if none.
 
+    raw_string_ostream Errs, Text, Raw, Latex, Configs; // Flushed into FR when destroyed.
 
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB)
-        getGoodnessAndDensityOfRegionInBB(BB, &DFGNodesRegion, &GoodDFGNodesRegion, &GoodnessRegion);
+  public:
+    unsigned Rejections[RR_NumRejections]; // # of Regions checkRegion rejected, by reason.
+    unsigned Skipped; // # of Regions not checked, as the Deadline had passed.
 
-      return GoodnessRegion;
+    RegionCoster(FunctionRegions &FR) : FR(FR), Graph(FR.Graph), Errs(FR.Diagnostics), Text(FR.Text),
+                                        Raw(FR.Raw), Latex(FR.Latex), Configs(FR.Configs), Skipped(0) {
 
+      std::fill(Rejections, Rejections + RR_NumRejections, 0);
     }
 
-     virtual unsigned int getDensityOfRegion(Region *R) {
-
-      unsigned int DFGNodesRegion = 0;
-      unsigned int GoodDFGNodesRegion = 0;
-      unsigned int GoodnessRegion = 0;
-      unsigned int DensityRegion = 0;
-
-
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB)
-        getGoodnessAndDensityOfRegionInBB(BB, &DFGNodesRegion, &GoodDFGNodesRegion, &GoodnessRegion);
-
+    void run(const CostingOptions &Opts) {
 
-      DensityRegion = static_cast<unsigned int> (GoodnessRegion / DFGNodesRegion) ; // Density of the Region.
+      std::vector<unsigned> Region_list;
+      std::vector<unsigned> Candidates;
 
-      return DensityRegion;
-    }
+      // All the Regions of the Region tree, nested ones included. They are
+      // numbered in pre-order, so parents come before their children.
+      for (unsigned N = 0; N < Graph.getNumRegions(); N++)
+        if (Graph.RegionDepth[N] >= Opts.MinDepth && Graph.RegionDepth[N] <= Opts.MaxDepth)
+          Candidates.push_back(N);
 
-    // Get the Area extimation of a Region in LUTs.
-    unsigned int getAreaofRegion(Region *R){
+      // Past the Deadline not even the tables of the Function are built.
+      if (Opts.HasDeadline && std::chrono::steady_clock::now() >= Opts.Deadline) {
+        Skipped = Candidates.size();
+        FR.Partial = true;
+        return;
+      }
 
-      unsigned int AreaOfRegion = 0;
+      BBMetrics.reset(Graph, RSCostModel);
+      RegMetrics.build(Graph, BBMetrics);
+      ConfigMetrics.reset(Graph, RSConfigModels, BBMetrics.getHistograms());
 
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB)
-        AreaOfRegion += getAreaOfBB(BB);
+      RS_VERBOSE(RSV_Summary, Errs << "\n\nFunction Name is : " << Graph.Name << "\n");
 
-      return AreaOfRegion;
+      RegionRows.assign(Graph.getNumRegions(), -1);
 
-    }
+      // Against a Deadline, the Regions with the most dynamic Instructions are
+      // costed first, so those left out when it passes are the coldest.
+      if (Opts.HasDeadline) {
 
-    // Get the Delay Estimation for the Region.
-    //
-    //
-    long int getHWCostOfRegion(Region *R) {
-
-      float DelayOfRegion, DelayOfRegionTotal = 0;
-      long int HardwareCost =0;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI(); 
-      std::vector<BasicBlock *> worklist, predecessor_bb, successor_bb;
-      std::vector<float> BBFreqPerIter;
-      std::vector<float> BBFreqTotal;
-      std::vector<float> DelayRegionPathsPerIter, DelayRegionPathsTotal;
-      std::vector<long int>   HWCostPath, HWCostBB;
-
-      // Clear vectors.
-      worklist.clear();
-      predecessor_bb.clear();
-      successor_bb.clear();
-      BBFreqPerIter.clear();
-      BBFreqTotal.clear();
-      DelayRegionPathsPerIter.clear();
-      DelayRegionPathsTotal.clear();
-      HWCostPath.clear();
-      HWCostBB.clear();
-
-      // Populate worklist with Region's Basic Blocks and their respective BB's Frequencies. Both Per Iteration and Total.
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
+        std::vector<double> DynInsts;
+        getDynamicInstsOfRegions(Graph, DynInsts);
 
-        float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-        int EntryFuncFreq = getEntryCount(R->block_begin()->getParent());
-        float BBFreq = BBFreqFloat * static_cast<float>(EntryFuncFreq);
-        
-        worklist.push_back(*BB);
-        BBFreqPerIter.push_back(BBFreqFloat);
-        BBFreqTotal.push_back(BBFreq);
-        HWCostBB.push_back(ceil( ( getDelayOfBB(*BB) ) / NSECS_PER_CYCLE ) * BBFreqTotal[find_bb(worklist, *BB)] ); // HW Cost for each BB (Cyclified) 
-        HWCostPath.push_back(ceil( ( getDelayOfBB(*BB) ) / NSECS_PER_CYCLE ) * BBFreqTotal[find_bb(worklist, *BB)] );
-
-    
+        std::stable_sort(Candidates.begin(), Candidates.end(),
+                         [&DynInsts](unsigned A, unsigned B) { return DynInsts[A] > DynInsts[B]; });
       }
 
-      errs() << "\n";
-      for (int i=0; i< worklist.size(); i++) {
-        errs() << " BBs in Region " << worklist[i]->getName() << " Freq per Iter " << BBFreqPerIter[i] <<  
-          " Freq Total " << BBFreqTotal[i] << " HW Cost BB " << HWCostBB[i] << "\n"; // My debugging Info!    
-      }
-
-      // Region has more than one BBs.
-      if (worklist.size() > 1) {
-
-        // Find Relations among BBs.
-        //
-        // Predecessor --> Successor
-        //
-        //
-        int count =0;  
-        
-        for (std::vector<BasicBlock *>::iterator bb_iter = worklist.begin(); bb_iter != worklist.end(); ++bb_iter, count++) {
+      // The Costs of the valid Regions, then printed in pre-order.
+      std::vector<RegionResultRow> Costs(Graph.getNumRegions());
+      std::vector<long int> ConfigSpeedups(Graph.getNumRegions() * ConfigMetrics.size());
+      std::vector<bool> Valid(Graph.getNumRegions(), false);
 
-          if(BasicBlock *BB = *bb_iter) {
-            // Getting the Succeror BBs of each BB in the worklist.
-            for (succ_iterator SI = succ_begin(BB), SE = succ_end(BB); SI != SE; ++SI) { 
-              
-              BasicBlock *Succ = *SI;      
-      
-              // if(count < find_bb(worklist, Succ) ) {  /// !!! CHANGED THIS !!!!!!
-              if(count != find_bb(worklist, Succ) ) { 
-                predecessor_bb.push_back(BB); // Populate send_node vector
-                successor_bb.push_back(Succ); // Populate receive_node vector
-              }
-            }
-          }
-        }
+      for (unsigned i = 0; i < Candidates.size(); i++) {
 
-        errs() << "\n\n"  ;
-        for (int i=0; i< predecessor_bb.size(); i++) {
-          errs() << " BB Edges in the Region : " << predecessor_bb[i]->getName() << "  --->     " <<  successor_bb[i]->getName() << "\n"; // My debugging Info!
+        if (Opts.HasDeadline && std::chrono::steady_clock::now() >= Opts.Deadline) {
+          Skipped = Candidates.size() - i;
+          FR.Partial = true;
+          break;
         }
-        errs() << "\n" ;
-
-        
-        // BEGIN OF WORK IN PROGRESS
 
-        // WORKING ON THAT!!!
-        int pos_successor = 0;
-        for (std::vector<BasicBlock *>::iterator succ_iter = successor_bb.begin(); succ_iter != successor_bb.end(); ++succ_iter, pos_successor++) {
-            BasicBlock *successor = *succ_iter;
+        unsigned N = Candidates[i];
 
-            errs() << "Counter : " << pos_successor << "\n" ;
+        // The scratch storage of the Region is released for the next one.
+        ScratchScope Scope;
+        ScratchVector<unsigned> Blocks;
+        RegionDataFlow DataFlow;
 
+        RegionRejection Rejection = checkRegion(Graph, N, RegMetrics, Opts.Limits, Blocks, DataFlow);
+        Rejections[Rejection]++;
 
-            if (find_bb(worklist, successor) == -1) {                       // Succesor is *not* in our worklist.
-
-              successor_bb.erase(successor_bb.begin() + pos_successor);             // deleting the edge
-              predecessor_bb.erase(predecessor_bb.begin() + pos_successor);        //  deleting the edge
-              succ_iter--;          // Be careful!!!
-              pos_successor--;       // Be careful!!!
-              continue;
-            }
-
-            int succ_pos_in_pred_list = find_bb(predecessor_bb, successor);
-            errs() << "  Successor position in pred list : " << succ_pos_in_pred_list << "\n";
-
-            if ( succ_pos_in_pred_list > pos_successor || succ_pos_in_pred_list == -1)        // Maybe put >= instead of >
-              continue;
-
-
-            int new_position = find_bb(successor_bb, predecessor_bb[pos_successor]);  
-
-
-              errs() << " Begin" << "\n";
-              errs() << " new_position " << new_position << "\n";
-              errs() << " position successor " << pos_successor << "\n";    
-
-
-            while (new_position < pos_successor && new_position !=-1) {
-
-              errs() << " new_position : " << new_position << "\n";
-              errs() << " position successor : " << pos_successor << "\n";
-
-              //int new_pos = find_bb(successor_bb, predecessor_bb[pos_successor]);
-
-              if (predecessor_bb[new_position] == successor) {
-
-                successor_bb.erase(successor_bb.begin() + pos_successor);             // deleting the edge
-                predecessor_bb.erase(predecessor_bb.begin() + pos_successor);        //  deleting the edge
-                succ_iter--;            // Be careful!!!
-                pos_successor--;         // Be careful!!!
-                new_position = pos_successor; // End the search. Maybe insert a break.
-              }
-
-              else
-                new_position = find_bb(successor_bb, predecessor_bb[new_position]); 
-
-            }
-
-
-        }
-
-        // END OF WORK IN PROGRESS
-
-        errs() << "\n\n   Updated Edges \n"  ;
-        for (int i=0; i< predecessor_bb.size(); i++) {
-          errs() << " BB Edges in the Region : " << predecessor_bb[i]->getName() << "  --->     " <<  successor_bb[i]->getName() << "\n"; // My debugging Info!
+        if (Rejection == RR_Valid) {
+          costRegion(N, Blocks, DataFlow, Costs[N], ConfigSpeedups.data() + N * ConfigMetrics.size());
+          Valid[N] = true;
         }
-        errs() << "\n" ;
-
-
-        // Critical Path Estimation. 
-        //       
-        // 
-        for (std::vector<BasicBlock *>::iterator bb_iter = worklist.begin(); bb_iter != worklist.end(); ++bb_iter) {
-
-          BasicBlock *BB = *bb_iter;
-
-          // Find the end Nodes - Bottom-most Nodes (BBs) in the CFG Graph.
-          if (find_bb(predecessor_bb, BB) == -1) {
-
-            BasicBlock *EndNode = BB;
-            std::vector<BasicBlock *> BottomNodes;
-            BottomNodes.clear();
-            BottomNodes.push_back(EndNode);
-
-
-            BasicBlock *CurrentNode;
-            int position, position_bottom_nodes = 0;
-  
-            long int hw_cost;  // Remove it when you are done!
-
-            while(BottomNodes.size()>0) {  
-             
-                CurrentNode = BottomNodes[0];
-     
-                errs() << " \n\nCurrentNode " << CurrentNode->getName() << "\n";
-                errs() << " \nBottom List Size " << BottomNodes.size() << "\n";
-                
-                
-                while (find_bb(successor_bb, CurrentNode) >=0) {
-
-                  position = find_bb(successor_bb, CurrentNode); 
-                  position_bottom_nodes = find_bb(BottomNodes, CurrentNode); // Should be zero.
-
-
-                  errs()  << CurrentNode->getName() << " " << HWCostPath[find_bb(worklist, CurrentNode)] ;
-                  errs() << " --> " << predecessor_bb[position]->getName() << " " << HWCostPath[find_bb(worklist, predecessor_bb[position])] << "\n";
-                  errs() << "Original \n" << CurrentNode->getName() << " " << HWCostPath[find_bb(worklist, CurrentNode)] ;
-                  errs() << " --> " << predecessor_bb[position]->getName() << " " << HWCostBB[find_bb(worklist, predecessor_bb[position])] << "\n";
-
-
-                  HWCostPath[find_bb(worklist, predecessor_bb[position])] = std::max( HWCostPath[find_bb(worklist, predecessor_bb[position])], HWCostBB[find_bb(worklist, predecessor_bb[position])] + HWCostPath[find_bb(worklist, CurrentNode)] );
-                  errs() << " Updated " << predecessor_bb[position]->getName() << " " << HWCostPath[find_bb(worklist, predecessor_bb[position])];
-                  
-                  BasicBlock *Predecessor = predecessor_bb[position];
+      }
 
-                  successor_bb.erase(successor_bb.begin() + position);            // deleting the last edge
-                  predecessor_bb.erase(predecessor_bb.begin() + position);        //  deleting the last edge
-                  
-                  errs() << "\nPredecessor in pred list  " <<  Predecessor->getName() << " " << find_bb(predecessor_bb, Predecessor) << "\n";
+      for (unsigned N = 0; N < Graph.getNumRegions(); N++) {
 
-                  if (find_bb(predecessor_bb, Predecessor) == -1)
-                    BottomNodes.push_back(Predecessor);
-                  
+        if (!Valid[N])
+          continue;
 
-                }
+        ScratchScope Scope;
+        ScratchVector<unsigned> Blocks;
+        getBlocksOfRegion(Graph, N, Blocks);
 
-                //BottomNodes.erase(BottomNodes.begin()+ position_bottom_nodes);
-                BottomNodes.erase(BottomNodes.begin());
-                errs() <<  "\n";
-                
-                errs() << " Bottom Nodes in list : \n" ;
-                for (int i=0; i< BottomNodes.size(); i++) {
-                  errs() << " Node : " << BottomNodes[i]->getName()  << "\n"; // My debugging Info!
-                }
+        Region_list.push_back(N);
 
-            }
-          }
-        }
-
-        HardwareCost       = get_max_long_int(HWCostPath);                // Total Cycles spent on HW.
+        RegionAnalysis(N, Blocks, Costs[N], ConfigSpeedups.data() + N * ConfigMetrics.size());
       }
 
-      // In case that the Region has only one BB.
-      // else if (worklist.size() == 1) {
-      else {
-        //DelayOfRegion      = getDelayOfBB(worklist[0]) * BBFreqPerIter[0];
-        //DelayOfRegionTotal = getDelayOfBB(worklist[0]) * BBFreqTotal[0];
-        HardwareCost       = ceil( ( getDelayOfBB(worklist[0]) ) / NSECS_PER_CYCLE ) * BBFreqTotal[0];
+      if (RS_VERBOSITY_AT_LEAST(RSV_Summary)) {
+        Errs << "   Valid Regions are : " << "\n" ;
+        for (int i=0; i< Region_list.size(); i++)
+          Errs << " Goodness " << RegMetrics.get(Region_list[i]).Goodness
+               << " Density " << RegMetrics.get(Region_list[i]).getDensity()
+               << "   Reg_Name " << Graph.getRegionName(Region_list[i])
+               << "\n" ;
       }
+    }
 
+    // Print the numbers of the Region's BBs in the Function.
+    void printBBRegionList(const ScratchVector<unsigned> &Blocks) {
 
+      for (unsigned i = 0; i < Blocks.size(); i++)
+        Text << Blocks[i]  << "," ;
 
-      return HardwareCost;
+      Text << "\n" ;
     }
 
-    // Get the Delay Estimation for the Region.
-    //
-    //
-    float getDelayOfRegion(Region *R) {
-
-      float DelayOfRegion, DelayOfRegionTotal = 0;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI(); 
-      std::vector<BasicBlock *> worklist, predecessor_bb, successor_bb;
-      std::vector<float> BBFreqPerIter;
-      std::vector<float> BBFreqTotal;
-      std::vector<float> DelayRegionPathsPerIter, DelayRegionPathsTotal;
-
-      // Clear vectors.
-      worklist.clear();
-      predecessor_bb.clear();
-      successor_bb.clear();
-      BBFreqPerIter.clear();
-      BBFreqTotal.clear();
-      DelayRegionPathsPerIter.clear();
-      DelayRegionPathsTotal.clear();
-
-      // Populate worklist with Region's Basic Blocks and their respective BB's Frequencies. Both Per Iteration and Total.
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
-
-        float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-        int EntryFuncFreq = getEntryCount(R->block_begin()->getParent());
-        float BBFreq = BBFreqFloat * static_cast<float>(EntryFuncFreq);
-        
-        worklist.push_back(*BB);
-        BBFreqPerIter.push_back(BBFreqFloat);
-        BBFreqTotal.push_back(BBFreq);
+    // Cost Region N, made of Blocks, into Row, and its Speedup under every
+    // -rs-configs model into ConfigSpeedups.
+    void costRegion(unsigned N, const ScratchVector<unsigned> &Blocks, const RegionDataFlow &DataFlow,
+                    RegionResultRow &Row, long int *ConfigSpeedups) {
+
+      RegionCosts Costs = getCostsOfRegion(Graph, N, Blocks, BBMetrics, RegMetrics);
+      Row.Speedup  = Costs.Speedup;
+      Row.SWCost   = Costs.SWCost;
+      Row.HWCost   = Costs.HWCost;
+      Row.Overhead = Costs.Overhead;
+      Row.Area     = RegMetrics.get(N).Area;
+      Row.Freq     = Costs.Freq;
+      Row.Depth    = Graph.RegionDepth[N];
+      Row.Inputs   = DataFlow.Inputs;
+      Row.Outputs  = DataFlow.Outputs;
+      Row.Loads    = DataFlow.Loads;
+      Row.Stores   = DataFlow.Stores;
+
+      if (ConfigMetrics.size()) {
+
+        RegionConfigCosts ConfigCosts;
+        getConfigCostsOfRegion(Graph, N, Blocks, ConfigMetrics, ConfigCosts);
+        std::copy(ConfigCosts.Speedup.begin(), ConfigCosts.Speedup.end(), ConfigSpeedups);
       }
+    }
 
-      // errs() << "\n";
-      // for (int i=0; i< worklist.size(); i++) {
-      //   errs() << " BBs in Region " << worklist[i]->getName() << " Freq per Iter " << BBFreqPerIter[i] <<  
-      //     " Freq Total " << BBFreqTotal[i] << "\n"; // My debugging Info!    
-      // }
-
-      // Region has more than one BBs.
-      if (worklist.size() > 1) {
-
-        // Find Relations among BBs.
-        //
-        // Predecessor --> Successor
-        //
-        //
-        int count =0;  
-        
-        for (std::vector<BasicBlock *>::iterator bb_iter = worklist.begin(); bb_iter != worklist.end(); ++bb_iter, count++) {
-
-          if(BasicBlock *BB = *bb_iter) {
-            // Getting the Succeror BBs of each BB in the worklist.
-            for (succ_iterator SI = succ_begin(BB), SE = succ_end(BB); SI != SE; ++SI) { 
-              
-              BasicBlock *Succ = *SI;      
-      
-              if(count < find_bb(worklist, Succ) ) { 
+    // Print the Costs of Region N, from costRegion, and write them to the
+    // Region files.
+    void PrintRegion(unsigned N, const RegionResultRow &Row, const long int *ConfigSpeedups) {
 
-                predecessor_bb.push_back(BB); // Populate send_node vector
-                successor_bb.push_back(Succ); // Populate receive_node vector
-              }
-            }
-          }
-        }
+      const RegionMetrics &Metrics = RegMetrics.get(N);
+      unsigned int BBRegionCounter = Metrics.BBs;
+      unsigned int DFGNodesRegion = Metrics.DFGNodes;
+      unsigned int GoodDFGNodesRegion = Metrics.GoodDFGNodes;
 
-        // errs() << "\n\n"  ;
-        // for (int i=0; i< predecessor_bb.size(); i++) {
-        //   errs() << " BB Edges in the Region : " << predecessor_bb[i]->getName() << "  --->     " <<  successor_bb[i]->getName() << "\n"; // My debugging Info!
-        // }
+      // Goodness and Density
+      unsigned int   OptimalityRegion = Metrics.Goodness;
+      float DensityRegion = Metrics.getDensity();
+      unsigned int AreaOfRegion = Metrics.Area;
 
+      // Costs to calculate Speedup.
+      double RegionFreq      = Row.Freq;
+      long int Cost_Software = Row.SWCost;
+      long int Cost_Hardware = Row.HWCost;
+      long int Overhead      = Row.Overhead;
+      long int Speedup       = Row.Speedup;
+
+      const std::string &FuncName = Graph.Name;
+      std::string RegionName = Graph.getRegionName(N);
+
+      if (RS_VERBOSITY_AT_LEAST(RSV_Region)) {
+        Errs << "\n\n";
+        Errs << "   **********************************************************************************" << '\n';
+        Errs << "   Function Name is : " << FuncName << "\n";
+        Errs << "   Region Depth  is : " << Graph.RegionDepth[N] << "\n";
+        Errs << "   Region Name   is : " << RegionName << "\n\n";
+      }
 
+      RS_VERBOSE(RSV_Trace, Errs << "We are here! \n");
 
-        // Critical Path Estimation. 
-        //       
-        // 
-        for (std::vector<BasicBlock *>::iterator bb_iter = worklist.begin(); bb_iter != worklist.end(); ++bb_iter) {
+      if (RS_VERBOSITY_AT_LEAST(RSV_Region)) {
+        Errs << "   -------------------------------------------------------------" << '\n';
+        Errs << "\n     BB Number is              : " << BBRegionCounter << "\n";
+        Errs << "     Good DFG Nodes are        : " << GoodDFGNodesRegion << "\n" ;
+        Errs << "     DFG Nodes Number is       : " << DFGNodesRegion << "\n\n";
+        Errs << "     Optimality of Region is   : " << OptimalityRegion << "\n";
+        Errs << "   -------------------------------------------------------------" << '\n';
 
-          BasicBlock *BB = *bb_iter;
+        Errs << "Good " << OptimalityRegion << " Dens " << static_cast<int>(DensityRegion) << " Func " <<
+          FuncName << " Reg " << RegionName
+          << " Speedup " << Speedup << " Cost_Software " << Cost_Software <<
+          " Cost_Hardware " << Cost_Hardware << " Overhead " << Overhead << " Area " << AreaOfRegion << "\n"  ;
+      }
 
-          // Find the end Nodes - Bottom-most Nodes (BBs) in the CFG Graph.
-          if (find_bb(predecessor_bb, BB) == -1) {
+      // Write Regions Identified in Regions.txt file.
+      Raw << FuncName <<  "\t" << RegionName << "\t"  << AreaOfRegion << "\t";
 
-            BasicBlock *EndNode = BB;
+      Raw << static_cast<int64_t>(RegionFreq) << "\t";
+      Raw << Speedup << "\t";
+      Raw << Cost_Software << "\t";
+      Raw << Cost_Hardware << " \t" << "\n";
 
-            BasicBlock *CurrentNode;
-            int position;
-            float delay_path_estimation, delay_path_estimation_total;
+      Text << FuncName << " " << RegionName << " "<< Speedup << " " << AreaOfRegion << " " ;
 
-            while(find_bb(successor_bb, EndNode)>=0) {  
+      // The Speedup under every -rs-configs model in Regions_configs.txt.
+      if (ConfigMetrics.size()) {
 
-              CurrentNode = EndNode;
-              position= 0;
-              delay_path_estimation= getDelayOfBB(CurrentNode) * BBFreqPerIter[find_bb(worklist, CurrentNode)];
-              delay_path_estimation_total = getDelayOfBB(CurrentNode) * BBFreqTotal[find_bb(worklist, CurrentNode)];
+        Configs << FuncName << "\t" << RegionName;
+        for (unsigned c = 0; c < ConfigMetrics.size(); c++)
+          Configs << "\t" << ConfigSpeedups[c];
+        Configs << "\n";
+      }
 
-              while (find_bb(successor_bb, CurrentNode) >=0) {
+      FR.RowNames.push_back(std::move(RegionName));
+    }
 
-                position = find_bb(successor_bb, CurrentNode); 
-                delay_path_estimation = delay_path_estimation + (getDelayOfBB(predecessor_bb[position]) * BBFreqPerIter[find_bb(worklist, predecessor_bb[position])]);
-                delay_path_estimation_total = delay_path_estimation_total + (getDelayOfBB(predecessor_bb[position]) * BBFreqTotal[find_bb(worklist, predecessor_bb[position])]);
-                CurrentNode = predecessor_bb[position];
+    // @return  The Row of the closest Region enclosing N that has results, -1 if none.
+    int32_t getParentRow(unsigned N) {
 
-                // errs() << "Delay for this node " << format("%.8f", getDelayEstim(send_node[position])) << "\n"; // My debugging Info!    
-                // errs() << "Delay path estim    " <<  format("%.8f", delay_path_estimation ) << "\n"; // My debugging Info!
-                // errs() << " Current Node is:   " << *CurrentNode << "\n";
-              }
+      for (int32_t P = Graph.RegionParent[N]; P >= 0; P = Graph.RegionParent[P])
+        if (RegionRows[P] >= 0)
+          return RegionRows[P];
 
-              // errs() << "Delay path estim    " <<  format("%.8f", delay_path_estimation ) << "\n"; // My debugging Info!
-              DelayRegionPathsPerIter.push_back(delay_path_estimation);
-              DelayRegionPathsTotal.push_back(delay_path_estimation_total);
-              successor_bb.erase(successor_bb.begin() + position);   // deleting the last edge
-              predecessor_bb.erase(predecessor_bb.begin() + position);        //  deleting the last edge
+      return -1;
+    }
 
-              
-            }
-          }
-        }
+    // @param  RegionName  Of Region N, as kept in FR.RowNames.
+    void PrintRegionInfo(unsigned N, const ScratchVector<unsigned> &Blocks, const std::string &RegionName) {
 
-        DelayOfRegion = get_max(DelayRegionPathsPerIter);       // Per Iteration.
-        DelayOfRegionTotal = get_max(DelayRegionPathsTotal);    // Total Delay.
-      }
+      // Gather Region Info
+      unsigned int NumberOfBBs   = RegMetrics.get(N).BBs;
+      unsigned int NumberOfLoops = getLoopsOfRegion(Graph, Blocks);
+      unsigned int NumberOfDFGNodes = RegMetrics.get(N).DFGNodes;
 
-      // In case that the Region has only one BB.
-      // else if (worklist.size() == 1) {
-      else {
-        DelayOfRegion      = getDelayOfBB(worklist[0]) * BBFreqPerIter[0];
-        DelayOfRegionTotal = getDelayOfBB(worklist[0]) * BBFreqTotal[0];
-      }
+      // Write Region Info to the file.
+      Latex << "$" << Graph.Name << "$" << " & "  << RegionName << " & " << NumberOfLoops << " & " <<  NumberOfBBs << " & " << NumberOfDFGNodes << "\n";
+    }
 
- 
+    // @param  Costs, ConfigSpeedups  Of Region N, from costRegion.
+    void RegionAnalysis(unsigned N, const ScratchVector<unsigned> &Blocks, const RegionResultRow &Costs,
+                        const long int *ConfigSpeedups) {
 
-      // errs() << " Delay Estimation for Region per Iteration is : " << format("%.8f", DelayOfRegion)      << " nSecs" << "\n";
-      // errs() << " Delay Estimation for Region Total         is : " << format("%.8f", DelayOfRegionTotal) << " nSecs" << "\n";
+      RegionResultRow Row = Costs;
+      PrintRegion(N, Row, ConfigSpeedups);
 
-      // errs() << " DEPI " << format("%.8f", DelayOfRegion);
-      // errs() << " DET " << format("%.8f", DelayOfRegionTotal) << " ";
+      Row.Parent  = getParentRow(N);
+      RegionRows[N] = FR.Rows.size();
+      FR.Rows.push_back(Row);
 
+      printBBRegionList(Blocks);
+      PrintRegionInfo(N, Blocks, FR.RowNames.back());
 
-      return DelayOfRegionTotal;
+      // The Loop and Array analysis, done in runOnFunction.
+      if (RS_VERBOSITY_AT_LEAST(RSV_Region))
+        Errs << FR.LoopInfoText[N];
     }
+  };
 
+  // The scratch arena of the thread is reset for every Function, so it only
+  // allocates when a Function needs more than any before it on this thread.
+  // Checking and costing the Regions allocate nothing else; what is kept of
+  // them, their names, rows and output text, is on the heap and not counted.
+  void costFunctionRegions(FunctionRegions *FR, const CostingOptions &Opts) {
+
+    ScratchArena &Arena = ScratchArena::get();
+    uint64_t HeapAllocations = Arena.getHeapAllocations();
+    unsigned Rejections[RR_NumRejections];
+    unsigned Skipped;
+
+    {
+      ScratchScope Scope;
+      RegionCoster Coster(*FR);
+      Coster.run(Opts);
+      std::copy(Coster.Rejections, Coster.Rejections + RR_NumRejections, Rejections);
+      Skipped = Coster.Skipped;
+    }
 
-    // Check to see if Region is Valid.
-    virtual bool isRegionValid(Region *R) {
-
-      if (R->getExit()) { // Check for Exit Block
+    ScratchAllocations += static_cast<unsigned>(Arena.getHeapAllocations() - HeapAllocations);
+    RejectedNoExit  += Rejections[RR_NoExit];
+    RejectedCall    += Rejections[RR_Call];
+    RejectedBlocks  += Rejections[RR_Blocks];
+    RejectedNodes   += Rejections[RR_Nodes];
+    RejectedFreq    += Rejections[RR_Freq];
+    RejectedInputs  += Rejections[RR_Inputs];
+    RejectedOutputs += Rejections[RR_Outputs];
+    SkippedRegions  += Skipped;
+    FR->Costed = true;
+  }
 
-        // Gather the input Data Flow for the Region.
-        int Input = gatherInput(R);
+  // The output of costed Functions, kept across runs in a directory with
+  // one file per Function, named after its key: a hash of everything the
+  // output depends on, see IdentifyRegions::getCacheKey. A file holds the
+  // key again, then the output of the FunctionRegions. Files are written
+  // under a temporary name and renamed, so concurrent runs may share the
+  // directory. The cache is only an optimization, any file that cannot be
+  // read or written is treated as missing.
+  class RegionCache {
 
-        // Gather the output Data Flow for the Region.
-        //
-        // We do not consider the whole function as possible Region.
-        // So Exit Block should not be NULL. (ExitBlock != NULL)
-        int Output = gatherOutput(R);
+    std::string Dir;
 
-        // Check if specified I/O Constraints are met.
-        if (isRegionCallFree(R))
-          return true;
+    std::string getPath(uint64_t Key) const {
 
-      }
+      char Name[32];
+      snprintf(Name, sizeof(Name), "%016llx.rsc", static_cast<unsigned long long>(Key));
 
-      return false;
+      SmallString<128> Path(Dir);
+      sys::path::append(Path, Name);
+      return Path.str().str();
     }
 
-    // Check to see if Region is Valid.
-    virtual bool isRegionCallFree(Region *R) {
-
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) 
-        if(!isBBCallFree(BB))
-          return false;
+    template <typename IO>
+    static void transfer(IO &S, int64_t &Key, FunctionRegions &FR) {
 
-      return true;
+      S.field(Key);
+      S.field(FR.Diagnostics);
+      S.field(FR.Text);
+      S.field(FR.Raw);
+      S.field(FR.Latex);
+      S.field(FR.Configs);
+      S.field(FR.RowNames);
     }
 
-    float getRegionTotalFreq (Region *R) {
-
-      
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
-      float RegionFreq = 0;
-      bool backedge = false;
-      Region::block_iterator BB_it_entry = R->block_begin();
-      BasicBlock * BB_entry = *BB_it_entry;
-      Function   *FunctionOfBB_entry = BB_entry->getParent();
+    // A Row as its integer fields and its Freq, RegionResultRow has padding.
+    template <typename IO>
+    static void transferRow(IO &S, RegionResultRow &Row) {
+
+      int64_t Fields[] = { Row.Parent, Row.Depth, Row.Speedup, Row.SWCost, Row.HWCost, Row.Overhead,
+                           Row.Area, Row.Inputs, Row.Outputs, Row.Loads, Row.Stores };
+      std::vector<int64_t> Values(Fields, Fields + sizeof(Fields) / sizeof(Fields[0]));
+      std::vector<double> Freq(1, Row.Freq);
+
+      S.field(Values);
+      S.field(Freq);
+
+      if (Values.size() != sizeof(Fields) / sizeof(Fields[0]) || Freq.size() != 1)
+        return;
+
+      Row.Parent   = Values[0];
+      Row.Depth    = Values[1];
+      Row.Speedup  = Values[2];
+      Row.SWCost   = Values[3];
+      Row.HWCost   = Values[4];
+      Row.Overhead = Values[5];
+      Row.Area     = Values[6];
+      Row.Inputs   = Values[7];
+      Row.Outputs  = Values[8];
+      Row.Loads    = Values[9];
+      Row.Stores   = Values[10];
+      Row.Freq     = Freq[0];
+    }
 
+  public:
+    bool isOpen() const { return !Dir.empty(); }
 
-      float BBEntryFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(BB_entry).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-      int EntryFuncFreq = getEntryCount(FunctionOfBB_entry);
-      float BBEntryFreq = BBEntryFreqFloat * static_cast<float>(EntryFuncFreq); // Freq_Total
+    // @return  false if Dir cannot be created.
+    bool open(const std::string &CacheDir) {
 
+      Dir = CacheDir;
+      return !sys::fs::create_directories(Dir);
+    }
 
-      // Case Entry of Region is Entry of Function.
-      if (BB_entry == FunctionOfBB_entry->begin())
-        return static_cast<float>(EntryFuncFreq);
+    // Fill the output of FR from the cache entry of Key.
+    //
+    // @return  false if there is none or it is unreadable.
+    bool load(uint64_t Key, FunctionRegions &FR) const {
 
+      std::ifstream File(getPath(Key).c_str(), std::ifstream::in | std::ifstream::binary);
 
-      if (BB_entry->getSinglePredecessor())
-        return BBEntryFreq;
-      
-      //else {
-        for (pred_iterator PI = pred_begin(BB_entry), PE = pred_end(BB_entry); PI != PE; ++PI) {
+      if (!File)
+        return false;
 
-          BasicBlock *BB_pred = *PI;
-          
-          if (R->contains(BB_pred)) {
-            backedge = true;
-            continue;
-          }
+      std::vector<char> Data((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+      RegionGraphReader Reader(Data.data(), Data.data() + Data.size());
+      int64_t StoredKey = 0, NumRows = 0;
 
-          if (BranchInst *Branch = dyn_cast<BranchInst>(&*BB_pred->getTerminator())) {
+      transfer(Reader, StoredKey, FR);
+      Reader.field(NumRows);
 
-            if (Branch->isUnconditional()) {
+      if (Reader.failed() || static_cast<uint64_t>(StoredKey) != Key ||
+          NumRows < 0 || static_cast<uint64_t>(NumRows) != FR.RowNames.size())
+        return false;
 
-              float BBPredFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(BB_pred).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-              int   PredFuncFreq = getEntryCount(FunctionOfBB_entry);
-              float BBPredFreq = BBPredFreqFloat * static_cast<float>(PredFuncFreq); // Freq_Total  
+      FR.Rows.resize(NumRows);
 
-              RegionFreq += BBPredFreq;
-            }
-          }
-        }
+      for (unsigned i = 0; i < FR.Rows.size() && !Reader.failed(); i++)
+        transferRow(Reader, FR.Rows[i]);
 
-        if (!backedge)
-          return BBEntryFreq;
+      for (unsigned i = 0; i < FR.Rows.size(); i++)
+        if (FR.Rows[i].Parent < -1 || FR.Rows[i].Parent >= static_cast<int32_t>(i))
+          return false;
 
-        return RegionFreq;
+      return !Reader.failed();
     }
 
-   // Software Cost for Regions Estimation.  **NEW**
-   //
-   long int getCostOnSoftwareRegion(Region *R) {
+    void store(uint64_t Key, FunctionRegions &FR) const {
 
-      Region::block_iterator BB_begin = R->block_begin();
-      Function   *FunctionOfBB = BB_begin->getParent();
+      std::string Data;
+      RegionGraphWriter Writer(Data);
+      int64_t StoredKey = Key;
 
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
-      long int Cost_Software_Region = 0;
+      transfer(Writer, StoredKey, FR);
+      Writer.field(static_cast<int64_t>(FR.Rows.size()));
 
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
+      for (unsigned i = 0; i < FR.Rows.size(); i++)
+        transferRow(Writer, FR.Rows[i]);
+
+      int FD;
+      SmallString<128> TempPath;
 
-        long int Cost_Software_BB = 0;
-        float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-        int EntryFuncFreq = getEntryCount(FunctionOfBB);
-        float BBFreq = BBFreqFloat * static_cast<float>(EntryFuncFreq);
+      if (sys::fs::createUniqueFile(getPath(Key) + "-%%%%%%%%.tmp", FD, TempPath))
+        return;
 
-        // Calculate the Software Cost in Cycles multiplied with the respective frequency of the BB.
-        Cost_Software_BB = static_cast<long int> (getSWCostOfBB(*BB) * BBFreq);
-        Cost_Software_Region += Cost_Software_BB;
+      bool Written;
+      {
+        raw_fd_ostream OS(FD, true);
+        OS << Data;
+        OS.close();
+        Written = !OS.has_error();
+        OS.clear_error();
       }
 
-      return Cost_Software_Region;
+      if (!Written || sys::fs::rename(TempPath, getPath(Key)))
+        sys::fs::remove(TempPath);
     }
+  };
 
-    void PrintRegion(Region *R) {
-
-
-
-      Region::block_iterator BB = R->block_begin();
-      Function   *FunctionOfBB = BB->getParent();
-
-
-      unsigned int BBRegionCounter = 0;
-      unsigned int DFGNodesRegion = 0;
-      unsigned int GoodDFGNodesRegion = 0;
-
-      // Goodness and Density
-      unsigned int   OptimalityRegion = 0;
-      float DensityRegion = 0;
-      unsigned int AreaOfRegion = getAreaofRegion(R);
-      float RegionFreq           = getRegionTotalFreq(R);
-      float DelayOfRegion        = getDelayOfRegion(R);
-      float DelayOfRegionPerIter = getDelayOfRegionPerIter(R);
+  struct IdentifyRegions : public FunctionPass {
+    static char ID; // Pass Identification, replacement for typeid
 
-      // Costs to calculate Speedup.
-      long int Cost_Software = 0;
-      long int Cost_Hardware = 0;
-      long int Overhead      = 0;
+    ResultFiles Results; // Output files, open for the whole Module.
+    std::string CostModelText; // RSCostModel and RSConfigModels as printed, part of the cache keys.
+    RegionCache Cache; // Open with -rs-cache-dir.
+    std::unique_ptr<ThreadPool> Pool; // Costs the Functions, if there is more than one thread.
+    std::vector<std::unique_ptr<FunctionRegions> > Functions; // Of the Module in order, reset once written.
+    unsigned NextToWrite; // The first of Functions not written yet.
+    CostingOptions Costing; // From the options, set in doInitialization.
 
-      std::vector<BasicBlock *> BB_list; // Worklist for Basic Blocks in Region.
-      BB_list.clear();
+    // Hot-first mode, with -rs-time-budget or -rs-coverage: the Functions to
+    // cost are picked by their dynamic Instructions when the pass starts, then
+    // costed in doFinalization, hottest first.
+    bool HotFirst;
+    DenseMap<const Function *, double> HotFunctions; // With their dynamic Instructions.
+    std::vector<FunctionRegions *> Deferred; // Not costed yet.
+    unsigned NumPartial; // # of Functions written with partial results.
 
-      errs() << "\n\n"; 
-      
-      // if (R->isSimple()) {
-      //   errs() << "   Simple Region **** "  << "\n";
-      //   ++SimpleRegionCounter;
-      // }
-      errs() << "   **********************************************************************************" << '\n';
-      errs() << "   Function Name is : " << FunctionOfBB->getName() << "\n";
-      errs() << "   Region Depth  is : " << R->getDepth() << "\n";
-      	//if(!R->getNameStr().empty())
-      	//	errs() << "   Region Name   is : " << R->getNameStr() << "\n\n";
-     	// 	errs() << "   Region Name   is : " << R->getEnteringBlock()->getName() << 
-	//       R->getExitingBlock()->getName()	<< "\n\n";
-      errs() << "   Region Name   is : " << R->getEntry()->getName() << " => " << R->getExit()->getName() << "\n\n";
+    IdentifyRegions() : FunctionPass(ID), NextToWrite(0), HotFirst(false), NumPartial(0) {}
 
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
+    bool doInitialization(Module &M) override {
 
-        //printBasicBlock(BB);
-        runOnBasicBlock(BB, &DFGNodesRegion, &GoodDFGNodesRegion, &OptimalityRegion);
-        //getCostOnSoftware(BB, &Cost_Software);
-        ++BBRegionCounter;
+      if (!Results.open(OutputDir, OutputPrefix, SaveSnapshots, !ConfigSpecs.empty()))
+        report_fatal_error(Twine("IdentifyRegions: cannot open the Region files in '") + OutputDir.getValue() + "'");
 
-        BB_list.push_back(*BB);
-  
-      }
+      std::string Error;
 
-      errs() << "We are here! \n" ;
+      if (!RSCostModel.configure(CostModelFile, Error))
+        report_fatal_error(Twine("IdentifyRegions: ") + Error);
 
-      DensityRegion = OptimalityRegion / DFGNodesRegion; // Density of the Region.
+      RSConfigModels.assign(ConfigSpecs.size(), CostModel());
 
-      Cost_Software = static_cast<long int> (getCostOnSoftwareRegion(R));
-      Cost_Hardware = static_cast<long int> (getHWCostOfRegion(R));
-      Overhead      = static_cast<long int> (RegionFreq * CALL_ACC_OVERHEAD);
+      for (unsigned i = 0; i < ConfigSpecs.size(); i++)
+        if (!RSConfigModels[i].configure(ConfigSpecs[i], Error))
+          report_fatal_error(Twine("IdentifyRegions: ") + Error);
 
-      // Final "Speedup" of a Region.
-      long int Speedup = Cost_Software - Cost_Hardware - Overhead;
+      std::ostringstream Model;
+      RSCostModel.print(Model);
+      for (unsigned i = 0; i < RSConfigModels.size(); i++)
+        RSConfigModels[i].print(Model << "# Configuration " << i << "\n");
+      CostModelText = Model.str();
 
+      if (!CacheDir.empty() && !Cache.open(CacheDir))
+        report_fatal_error(Twine("IdentifyRegions: cannot open the cache in '") + CacheDir.getValue() + "'");
 
+      Functions.clear();
+      NextToWrite = 0;
 
-      errs() << "   -------------------------------------------------------------" << '\n';
-      errs() << "\n     BB Number is              : " << BBRegionCounter << "\n";
-      errs() << "     Good DFG Nodes are        : " << GoodDFGNodesRegion << "\n" ; 
-      errs() << "     DFG Nodes Number is       : " << DFGNodesRegion << "\n\n";
-      errs() << "     Optimality of Region is   : " << OptimalityRegion << "\n";
-      //errs() << "     Density of Region is      : " << DensityRegion << "\n\n";
-      errs() << "   -------------------------------------------------------------" << '\n';
-   
-      errs() << "Good " << OptimalityRegion << " Dens " << static_cast<int>(DensityRegion) << " Func " << 
-        FunctionOfBB->getName() << " Reg " << 
-	//R->getNameStr()  // Replaced it because of synbol lookup error
- 	R->getEntry()->getName() <<" => " << R->getExit()->getName()
-	<< " Speedup " << Speedup << " Cost_Software " << Cost_Software << 
-         " Cost_Hardware " << Cost_Hardware << " Overhead " << Overhead << " Area " << AreaOfRegion << "\n"  ;
-
-     // Write Regions Identified in Regions.txt file.
-     std::string FuncName   = FunctionOfBB->getName(); 
-     //std::string RegionName = R->getNameStr(); // Replaced it because of synbol lookup error
-     std::string entryName = R->getEntry()->getName();
-     std::string exitName = R->getExit()->getName();
-     std::string RegionName = entryName + " => " + exitName;
-
-      myrawfile.open ("Regions_raw.txt", std::ofstream::out | std::ofstream::app); 
-      myrawfile << FuncName <<  "\t" << RegionName << "\t"  << AreaOfRegion << "\t";
-
-      myrawfile << static_cast<int>(RegionFreq) << "\t";
-      myrawfile << Speedup << "\t";
-      myrawfile << Cost_Software << "\t";
-      myrawfile << Cost_Hardware << " \t" << "\n";
-      myrawfile.close();
-
-     myfile.open ("Regions.txt", std::ofstream::out | std::ofstream::app); 
-     myfile << FuncName << " " << RegionName << " "<< Speedup << " " << AreaOfRegion << " " ;
-     myfile.close();
+      Costing = CostingOptions();
+      Costing.MinDepth = RegionMinDepth;
+      Costing.MaxDepth = RegionMaxDepth;
+      Costing.Limits.MaxBlocks  = RegionMaxBlocks;
+      Costing.Limits.MaxNodes   = RegionMaxNodes;
+      Costing.Limits.MinFreq    = RegionMinFreq;
+      Costing.Limits.MaxInputs  = RegionMaxInputs;
+      Costing.Limits.MaxOutputs = RegionMaxOutputs;
 
-  }
+      if (!TimeBudget.empty()) {
 
-  void PrintRegionInfo(Region *R) {
+        double Seconds;
+        if (!parseTime(TimeBudget, Seconds))
+          report_fatal_error(Twine("IdentifyRegions: malformed time budget '") + TimeBudget.getValue() + "'");
 
-    // Loop Information
-    LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
-    Region::block_iterator BB = R->block_begin();
-    Function   *FunctionOfBB  = BB->getParent();
+        Costing.HasDeadline = true;
+        Costing.Deadline = std::chrono::steady_clock::now() +
+                           std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(Seconds));
+      }
 
-    // Gather Region Info
-    std::string FuncName       = FunctionOfBB->getName(); 
-    //std::string RegionName = R->getNameStr(); // Replaced it because of synbol lookup error
-    std::string entryName = R->getEntry()->getName();
-    std::string exitName = R->getExit()->getName();
-    std::string RegionName = entryName + " => " + exitName;
-    unsigned int NumberOfBBs   = getBBsOfRegion(R);
-    unsigned int NumberOfLoops = getLoopsOfRegion(R, LI);
-    unsigned int NumberOfDFGNodes = getDFGNodesOfRegion(R);
+      HotFirst = Costing.HasDeadline || Coverage < 1;
+      HotFunctions.clear();
+      Deferred.clear();
+      NumPartial = 0;
 
-    // Write Region Info to the file.
-    region_info_latex.open ("Region_info_latex.txt", std::ofstream::out | std::ofstream::app); 
-    region_info_latex << "$" <<FuncName << "$" << " & "  <<RegionName << " & " << NumberOfLoops << " & " <<  NumberOfBBs << " & " << NumberOfDFGNodes << "\n";
-    region_info_latex.close();
+      if (HotFirst)
+        pickHotFunctions(M);
 
-  }
+      unsigned NumThreads = Threads ? Threads : std::thread::hardware_concurrency();
+      if (NumThreads > 1)
+        Pool.reset(new ThreadPool(NumThreads));
 
+      return false;
+    }
 
-    virtual bool RegionAnalysis (Region *R) {
-      if (R->getExit()) { // Check for Exit Block
+    bool doFinalization(Module &M) override {
 
-        std::vector<BasicBlock *> Function_BB_list;
-        Function_BB_list.clear();
+      // The Functions of hot-first mode, see runOnFunction.
+      std::stable_sort(Deferred.begin(), Deferred.end(),
+                       [](const FunctionRegions *A, const FunctionRegions *B) { return A->Weight > B->Weight; });
 
-        Function *F = R->block_begin()->getParent();
+      for (unsigned i = 0; i < Deferred.size(); i++)
+        costFunction(Deferred[i]);
+      Deferred.clear();
 
-        // Gather Block of the function.
-        for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+      writeCostedFunctions(true);
+      Pool.reset();
+      ScratchArena::destroyAll();
 
-          if(find_bb(Function_BB_list, &*BB) == -1)
-            Function_BB_list.push_back(&*BB);
+      if (NumPartial && RS_VERBOSITY_AT_LEAST(RSV_Summary))
+        errs() << "IdentifyRegions: partial results, " << NumPartial << " Functions not costed in full"
+               << " within -rs-time-budget or -rs-coverage\n";
 
-        }
+      if (!Results.close())
+        report_fatal_error(Twine("IdentifyRegions: cannot write the Region files in '") + OutputDir.getValue() + "'");
 
-        //errs()<< "BB list size is : "  << Function_BB_list.size() << "\n"; // This was used for Debug!
+      return false;
+    }
 
+    // @param  Time  Seconds, or with a unit, s or ms, e.g. 5s.
+    static bool parseTime(const std::string &Time, double &Seconds) {
 
-        // Gather the input Data Flow for the Region.
-        int Input = gatherInput(R);
+      char *End;
+      Seconds = std::strtod(Time.c_str(), &End);
+      std::string Unit(End);
 
-        // Gather the output Data Flow for the Region.
-        //
-        // We do not consider the whole function as possible Region.
-        // So Exit Block should not be NULL. (ExitBlock != NULL)
-        int Output = gatherOutput(R);
+      if (End == Time.c_str() || Seconds < 0)
+        return false;
 
-        // Check if specified I/O Constraints are met.
-        //if (Input<= User_Input && Output<=User_Output) {
+      if (Unit == "ms")
+        Seconds /= 1000;
+      else if (!Unit.empty() && Unit != "s")
+        return false;
 
+      return true;
+    }
 
-          //float test_2 = getDelayOfRegion(R); // Test_2 Remove it after you are done!
-          
-          PrintRegion(R);
-          // errs() << " I " << Input << " O " << Output ;
-          // int InputData  = getInputData(R);
-          // int OutputData = getOutputData(R);
-          // errs() << " Func_Freq "  << getEntryCount(R->block_begin()->getParent()); // Function Entry Count Print!
-          // errs() << " A " << getAreaofRegion(R) ;// Print Area of the Region
-          //getDelayOfRegion(R);
-          printBBRegionList(R, Function_BB_list);
-          
+    // Dynamic Instructions of F: those of its BBs weighted by their annotated
+    // Frequencies, or by the entry count of F if none is annotated.
+    double getDynamicInsts(Function &F) {
 
-          // errs() << "     Input   Data is :  " << InputData  << "\n";
-          // errs() << "     Output  Data is :  " << OutputData << "\n";
+      double Annotated = 0, Insts = 0;
 
-          // Loops Information
-          LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
-          ScalarEvolution &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+      for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+        Annotated += static_cast<double>(getAnnotatedFreqOfBB(&*BB)) * BB->size();
+        Insts += BB->size();
+      }
 
-          PrintRegionInfo(R);
+      return Annotated > 0 ? Annotated : Insts * static_cast<double>(getEntryCount(&F));
+    }
 
-          unsigned int NumberOfLoops = 0;
-          unsigned int NumberOfArrays = 0;
+    // The hottest Functions of M that hold the -rs-coverage fraction of its
+    // dynamic Instructions, into HotFunctions.
+    void pickHotFunctions(Module &M) {
 
-          getNumberOfLoopsandArrays(NumberOfLoops, NumberOfArrays, R, LI, SE);
-          errs() << "     Number Of loops  : " << NumberOfLoops   << '\n';
-          errs() << "     Number Of Arrays : " << NumberOfArrays  << '\n';
+      std::vector<std::pair<double, Function *> > Weights;
+      double Total = 0;
 
-          if (NumberOfLoops) { // Might need to add NumberOfArrays as arguments inside the if statement!
+      for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
 
-            int InputLoop  = getInputDataLoop(R, LI, SE, NumberOfLoops, NumberOfArrays);
-            int OutputLoop = getOutputDataLoop(R, LI, SE, NumberOfLoops);
-          }
+        if (F->isDeclaration())
+          continue;
 
-          // Print Static - Dynamic Classification.
-          PrintSDClassification(R, LI, SE);
-          errs() << "   **********************************************************************************" << '\n';
+        Weights.push_back(std::make_pair(getDynamicInsts(*F), &*F));
+        Total += Weights.back().first;
+      }
 
-        //} // End of if User Input/Outut specified.
-      } // End of If Exit Block check.
+      // Without any profile, the static Instructions stand for the dynamic ones.
+      if (Total == 0)
+        for (unsigned i = 0; i < Weights.size(); i++) {
+          for (Function::iterator BB = Weights[i].second->begin(), E = Weights[i].second->end(); BB != E; ++BB)
+            Weights[i].first += BB->size();
+          Total += Weights[i].first;
+        }
 
+      std::stable_sort(Weights.begin(), Weights.end(),
+                       [](const std::pair<double, Function *> &A, const std::pair<double, Function *> &B) {
+                         return A.first > B.first;
+                       });
 
+      double Covered = 0;
 
-      return false;
+      for (unsigned i = 0; i < Weights.size() && (Coverage >= 1 || Covered < Coverage * Total); i++) {
+        HotFunctions[Weights[i].second] = Weights[i].first;
+        Covered += Weights[i].first;
+      }
+    }
 
+    // Cost FR, on the pool if there is one.
+    void costFunction(FunctionRegions *FR) {
 
+      CostingOptions Opts = Costing;
 
+      // Past the Deadline RegionCoster::run returns at once, no need for the
+      // pool.
+      if (Pool && !(Opts.HasDeadline && std::chrono::steady_clock::now() >= Opts.Deadline))
+        Pool->async([FR, Opts]() { costFunctionRegions(FR, Opts); });
+      else
+        costFunctionRegions(FR, Opts);
     }
 
+    bool runOnFunction(Function &F) override {
 
-    void gatherRegionsGoodnessAndDensity(Region *R) {
+      RegionInfo &RI = getAnalysis<RegionInfoPass>().getRegionInfo();
+      LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+      ScalarEvolution &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+      auto *TLIP = getAnalysisIfAvailable<TargetLibraryInfoWrapperPass>();
 
+      FunctionRegions *FR = new FunctionRegions();
+      Functions.push_back(std::unique_ptr<FunctionRegions>(FR));
 
+      // In hot-first mode, a Function too cold for -rs-coverage, or reached
+      // after the time budget ran out, is written without Regions.
+      if (HotFirst) {
 
-      Region::block_iterator BB = R->block_begin();
-      Function   *FunctionOfBB = BB->getParent();
+        DenseMap<const Function *, double>::iterator Hot = HotFunctions.find(&F);
 
+        if (Hot == HotFunctions.end() ||
+            (Costing.HasDeadline && std::chrono::steady_clock::now() >= Costing.Deadline)) {
+          FR->Graph.Name = F.getName().str();
+          FR->Partial = true;
+          FR->Costed = true;
+          writeCostedFunctions(false);
+          return false;
+        }
 
-      unsigned int BBRegionCounter = 0;
-      unsigned int DFGNodesRegion = 0;
-      unsigned int GoodDFGNodesRegion = 0;
+        FR->Weight = Hot->second;
+      }
 
-      unsigned int   OptimalityRegion = 0;
-      float DensityRegion = 0;
+      DenseMap<const Region *, unsigned> RegionNumbers;
+      lowerFunction(F, RI, LI, getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI(), SE,
+                    TLIP ? &TLIP->getTLI() : nullptr, getEntryCount(&F), FR->Graph, RegionNumbers);
+      Results.saveSnapshot(FR->Graph);
 
+      analyzeLoopsOfRegions(RI, LI, SE, RegionNumbers, *FR);
 
-      // std::vector<BasicBlock *> BB_list; // Worklist for Basic Blocks in Region.
-      // BB_list.clear();
+      if (Cache.isOpen()) {
 
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
+        FR->Key = getCacheKey(*FR);
 
-        runOnBasicBlock(BB, &DFGNodesRegion, &GoodDFGNodesRegion, &OptimalityRegion);
+        if (!CacheInvalidate && Cache.load(FR->Key, *FR)) {
+          ++CacheHits;
+          FR->FromCache = true;
+          FR->Costed = true;
+          writeCostedFunctions(false);
+          return false;
+        }
 
+        // A cache entry that failed to load may have filled part of FR.
+        FR->Diagnostics.clear();
+        FR->Text.clear();
+        FR->Raw.clear();
+        FR->Latex.clear();
+        FR->Configs.clear();
+        FR->Rows.clear();
+        FR->RowNames.clear();
+        ++CacheMisses;
       }
 
-      DensityRegion = OptimalityRegion / DFGNodesRegion; // Density of the Region.
+      // Everything else is done on FR->Graph, in hot-first mode once all the
+      // Functions are known.
+      if (HotFirst)
+        Deferred.push_back(FR);
+      else
+        costFunction(FR);
 
+      writeCostedFunctions(false);
 
-      errs() << "   -------------------------------------------------------------" << '\n';
-      errs() << "\n     BB Number is              : " << BBRegionCounter << "\n";
-      errs() << "     Good DFG Nodes are        : " << GoodDFGNodesRegion << "\n" ; 
-      errs() << "     DFG Nodes Number is       : " << DFGNodesRegion << "\n\n";
-      errs() << "     Optimality of Region is   : " << OptimalityRegion << "\n";
-      errs() << "     Density of Region is      : " << DensityRegion << "\n\n";
-      errs() << "   -------------------------------------------------------------" << '\n';
-   
-      errs() << "Good " << OptimalityRegion << " Dens " << static_cast<int>(DensityRegion) << " Func " << \
-        FunctionOfBB->getName() << " Reg " << R->getNameStr() ;
+      // Print the DFG Graphs.
+      //for(Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+      //  DFGPrinterBB(&*BB); // Activate to print the DFG graphs.
+
+      return false;
     }
 
+    // The cache key of FR: its snapshot, its Loop and Array analysis, the
+    // options that change its output and the cost model.
+    uint64_t getCacheKey(const FunctionRegions &FR) {
+
+      RegionGraphHasher Hasher;
+
+      Hasher.field(FR.Graph);
+      Hasher.field(FR.LoopInfoText);
+      Hasher.field(std::min<int64_t>(RSVerbosity, RS_MAX_VERBOSITY));
+      Hasher.field(RegionMinDepth.getValue());
+      Hasher.field(RegionMaxDepth.getValue());
+      Hasher.field(RegionMaxBlocks.getValue());
+      Hasher.field(RegionMaxNodes.getValue());
+      Hasher.field(std::vector<double>(1, RegionMinFreq.getValue()));
+      Hasher.field(RegionMaxInputs.getValue());
+      Hasher.field(RegionMaxOutputs.getValue());
+      Hasher.field(COST_MODEL_VERSION);
+      Hasher.field(CostModelText);
+
+      return Hasher.getHash();
+    }
 
+    // Write the output of the Functions costed so far, in order, up to the
+    // first one that is not costed yet. With Wait, all of them are.
+    void writeCostedFunctions(bool Wait) {
 
-    // Get the Delay Estimation for the Region.
-    //
-    //
-    float getDelayOfRegionPerIter(Region *R) {
-
-      float DelayOfRegion, DelayOfRegionTotal = 0;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI(); 
-      std::vector<BasicBlock *> worklist, predecessor_bb, successor_bb;
-      std::vector<float> BBFreqPerIter;
-      std::vector<float> BBFreqTotal;
-      std::vector<float> DelayRegionPathsPerIter, DelayRegionPathsTotal;
-
-      // Clear vectors.
-      worklist.clear();
-      predecessor_bb.clear();
-      successor_bb.clear();
-      BBFreqPerIter.clear();
-      BBFreqTotal.clear();
-      DelayRegionPathsPerIter.clear();
-      DelayRegionPathsTotal.clear();
-
-      // Populate worklist with Region's Basic Blocks and their respective BB's Frequencies. Both Per Iteration and Total.
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
+      if (Wait && Pool)
+        Pool->wait();
 
-        float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-        int EntryFuncFreq = getEntryCount(R->block_begin()->getParent());
-        float BBFreq = BBFreqFloat * static_cast<float>(EntryFuncFreq);
-        
-        worklist.push_back(*BB);
-        BBFreqPerIter.push_back(BBFreqFloat);
-        BBFreqTotal.push_back(BBFreq);
-      }
+      for (; NextToWrite < Functions.size() && Functions[NextToWrite]->Costed; NextToWrite++) {
 
-      // errs() << "\n";
-      // for (int i=0; i< worklist.size(); i++) {
-      //   errs() << " BBs in Region " << worklist[i]->getName() << " Freq per Iter " << BBFreqPerIter[i] <<  
-      //     " Freq Total " << BBFreqTotal[i] << "\n"; // My debugging Info!    
-      // }
-
-      // Region has more than one BBs.
-      if (worklist.size() > 1) {
-
-        // Find Relations among BBs.
-        //
-        // Predecessor --> Successor
-        //
-        //
-        int count =0;  
-        
-        for (std::vector<BasicBlock *>::iterator bb_iter = worklist.begin(); bb_iter != worklist.end(); ++bb_iter, count++) {
+        FunctionRegions &FR = *Functions[NextToWrite];
 
-          if(BasicBlock *BB = *bb_iter) {
-            // Getting the Succeror BBs of each BB in the worklist.
-            for (succ_iterator SI = succ_begin(BB), SE = succ_end(BB); SI != SE; ++SI) { 
-              
-              BasicBlock *Succ = *SI;      
-      
-              if(count < find_bb(worklist, Succ) ) { 
+        // Partial results are not cached, they depend on the time left.
+        if (Cache.isOpen() && !FR.FromCache && !FR.Partial)
+          Cache.store(FR.Key, FR);
 
-                predecessor_bb.push_back(BB); // Populate send_node vector
-                successor_bb.push_back(Succ); // Populate receive_node vector
-              }
-            }
-          }
+        if (FR.Partial) {
+          ++PartialFunctions;
+          NumPartial++;
         }
 
-        // errs() << "\n\n"  ;
-        // for (int i=0; i< predecessor_bb.size(); i++) {
-        //   errs() << " BB Edges in the Region : " << predecessor_bb[i]->getName() << "  --->     " <<  successor_bb[i]->getName() << "\n"; // My debugging Info!
-        // }
-
-
+        errs() << FR.Diagnostics;
+        myfile << FR.Text;
+        myrawfile << FR.Raw;
+        region_info_latex << FR.Latex;
+        if (Results.Configs.is_open())
+          Results.Configs << FR.Configs;
 
-        // Critical Path Estimation. 
-        //       
-        // 
-        for (std::vector<BasicBlock *>::iterator bb_iter = worklist.begin(); bb_iter != worklist.end(); ++bb_iter) {
+        // The Rows of a Function are contiguous, Parents are relative to the first.
+        int32_t FirstRow = Results.Binary.getNumRegions();
+        Results.Binary.beginFunction(FR.Graph.Name, FR.Partial ? RRF_Partial : 0);
 
-          BasicBlock *BB = *bb_iter;
+        for (unsigned i = 0; i < FR.Rows.size(); i++) {
 
-          // Find the end Nodes - Bottom-most Nodes (BBs) in the CFG Graph.
-          if (find_bb(predecessor_bb, BB) == -1) {
+          RegionResultRow Row = FR.Rows[i];
+          Row.Name = Results.Binary.intern(FR.RowNames[i]);
 
-            BasicBlock *EndNode = BB;
+          if (Row.Parent >= 0)
+            Row.Parent += FirstRow;
 
-            BasicBlock *CurrentNode;
-            int position;
-            float delay_path_estimation, delay_path_estimation_total;
+          Results.Binary.addRegion(Row);
+        }
 
-            while(find_bb(successor_bb, EndNode)>=0) {  
+        Functions[NextToWrite].reset();
+      }
+    }
 
-              CurrentNode = EndNode;
-              position= 0;
-              delay_path_estimation= getDelayOfBB(CurrentNode) * BBFreqPerIter[find_bb(worklist, CurrentNode)];
-              delay_path_estimation_total = getDelayOfBB(CurrentNode) * BBFreqTotal[find_bb(worklist, CurrentNode)];
+    // The Loop and Array analysis of the Regions of F that are valid, written
+    // to FR.LoopInfoText. It needs the LLVM analyses of F, so it is done here
+    // rather than when FR is costed, and only if it is printed.
+    void analyzeLoopsOfRegions(RegionInfo &RI, LoopInfo &LI, ScalarEvolution &SE,
+                               const DenseMap<const Region *, unsigned> &RegionNumbers, FunctionRegions &FR) {
 
-              while (find_bb(successor_bb, CurrentNode) >=0) {
+      if (!RS_VERBOSITY_AT_LEAST(RSV_Region))
+        return;
 
-                position = find_bb(successor_bb, CurrentNode); 
-                delay_path_estimation = delay_path_estimation + (getDelayOfBB(predecessor_bb[position]) * BBFreqPerIter[find_bb(worklist, predecessor_bb[position])]);
-                delay_path_estimation_total = delay_path_estimation_total + (getDelayOfBB(predecessor_bb[position]) * BBFreqTotal[find_bb(worklist, predecessor_bb[position])]);
-                CurrentNode = predecessor_bb[position];
+      std::vector<Region *> Candidates;
+      std::vector<bool> CallFree;
 
-                // errs() << "Delay for this node " << format("%.8f", getDelayEstim(send_node[position])) << "\n"; // My debugging Info!    
-                // errs() << "Delay path estim    " <<  format("%.8f", delay_path_estimation ) << "\n"; // My debugging Info!
-                // errs() << " Current Node is:   " << *CurrentNode << "\n";
-              }
+      getRegionsOfTree(RI.getTopLevelRegion(), RegionMinDepth, RegionMaxDepth, Candidates);
+      getCallFreeRegions(FR.Graph, CallFree);
+      FR.LoopInfoText.resize(FR.Graph.getNumRegions());
 
-              // errs() << "Delay path estim    " <<  format("%.8f", delay_path_estimation ) << "\n"; // My debugging Info!
-              DelayRegionPathsPerIter.push_back(delay_path_estimation);
-              DelayRegionPathsTotal.push_back(delay_path_estimation_total);
-              successor_bb.erase(successor_bb.begin() + position);   // deleting the last edge
-              predecessor_bb.erase(predecessor_bb.begin() + position);        //  deleting the last edge
+      for (unsigned i = 0; i < Candidates.size(); i++) {
 
-              
-            }
-          }
-        }
+        Region *R = Candidates[i];
+        unsigned N = RegionNumbers.find(R)->second;
 
-        DelayOfRegion = get_max(DelayRegionPathsPerIter);       // Per Iteration.
-        DelayOfRegionTotal = get_max(DelayRegionPathsTotal);    // Total Delay.
-      }
+        if (!R->getExit() || !CallFree[N])
+          continue;
 
-      // In case that the Region has only one BB.
-      // else if (worklist.size() == 1) {
-      else {
-        DelayOfRegion      = getDelayOfBB(worklist[0]) * BBFreqPerIter[0];
-        DelayOfRegionTotal = getDelayOfBB(worklist[0]) * BBFreqTotal[0];
-      }
+        raw_string_ostream OS(FR.LoopInfoText[N]);
 
- 
+        unsigned int NumberOfLoops = 0;
+        unsigned int NumberOfArrays = 0;
 
-      // errs() << " Delay Estimation for Region per Iteration is : " << format("%.8f", DelayOfRegion)      << " nSecs" << "\n";
-      // errs() << " Delay Estimation for Region Total         is : " << format("%.8f", DelayOfRegionTotal) << " nSecs" << "\n";
+        getNumberOfLoopsandArrays(NumberOfLoops, NumberOfArrays, R, LI, SE, OS);
+        OS << "     Number Of loops  : " << NumberOfLoops   << '\n';
+        OS << "     Number Of Arrays : " << NumberOfArrays  << '\n';
 
-      // errs() << " DEPI " << format("%.8f", DelayOfRegion);
-      // errs() << " DET " << format("%.8f", DelayOfRegionTotal) << " ";
+        if (NumberOfLoops) { // Might need to add NumberOfArrays as arguments inside the if statement!
 
+          int InputLoop  = getInputDataLoop(R, LI, SE, NumberOfLoops, NumberOfArrays, OS);
+          int OutputLoop = getOutputDataLoop(R, LI, SE, NumberOfLoops, OS);
+        }
 
-      return DelayOfRegion;
+        // Print Static - Dynamic Classification.
+        PrintSDClassification(R, LI, SE, OS);
+        OS << "   **********************************************************************************" << '\n';
+      }
     }
 
+    virtual void getNumberOfLoopsandArrays (unsigned int &NumberOfLoops, unsigned int &NumberOfArrays, Region *R, LoopInfo &LI, ScalarEvolution &SE, raw_ostream &OS) {
 
-    virtual void getNumberOfLoopsandArrays (unsigned int &NumberOfLoops, unsigned int &NumberOfArrays, Region *R, LoopInfo &LI, ScalarEvolution &SE ) {
-
-      std::vector<Loop *> Loops;
-      Loops.clear();
+      SmallPtrSet<Loop *, 8> Loops;
       std::vector<Value *> ArrayReferences;
       ArrayReferences.clear();
 
@@ -1070,17 +1000,17 @@ namespace {
 
         // Iterate inside the Loop.
         if (Loop *L = LI.getLoopFor(CurrentBlock)) {
-            errs() << "\n     Num of Back Edges     : " << L->getNumBackEdges() << "\n";
-            errs() << "     Loop Depth            : " << L->getLoopDepth() << "\n";
-            errs() << "     Backedge Taken Count  : " << *SE.getBackedgeTakenCount(L) << '\n';
-            errs() << "     Loop iterations       : " << SE.getSmallConstantTripCount(L) << "\n\n";
+            if (RS_VERBOSITY_AT_LEAST(RSV_Trace)) {
+              OS << "\n     Num of Back Edges     : " << L->getNumBackEdges() << "\n";
+              OS << "     Loop Depth            : " << L->getLoopDepth() << "\n";
+              OS << "     Backedge Taken Count  : " << *SE.getBackedgeTakenCount(L) << '\n';
+              OS << "     Loop iterations       : " << SE.getSmallConstantTripCount(L) << "\n\n";
+            }
 
             NumberOfArrays += GatherNumberOfArrays(CurrentBlock, ArrayReferences); 
 
-            if (find_loop(Loops, L) == -1 ){ 
-                Loops.push_back(L);
-                NumberOfLoops++;
-              }
+            if (Loops.insert(L).second)
+              NumberOfLoops++;
 
 
         }
@@ -1089,53 +1019,15 @@ namespace {
     }
    
 
-    virtual int getInputData(Region *R) {
+    virtual int getInputDataLoop(Region *R, LoopInfo &LI, ScalarEvolution &SE, unsigned int NumberOfLoops, unsigned int NumberOfArrays, raw_ostream &OS) {
 
       int InputData = 0;
       int NumberOfLoads = 0;
 
-    for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
-      BasicBlock *CurrentBlock = *BB;
-
-      // Iterate inside the basic block.
-      for(BasicBlock::iterator BI = CurrentBlock->begin(), BE = CurrentBlock->end(); BI != BE; ++BI) {
-
-        //if(Instruction *Inst = dyn_cast<Instruction>(&*BI)) {
-
-         // Do not consider Branch Instructions.
-         if (dyn_cast<BranchInst>(&*BI))
-          continue;
-
-          // Load Info
-          if(LoadInst *Load = dyn_cast<LoadInst>(&*BI)) {
-
-            // Non-Atomic and Non-Volatile Load.
-            // if (Load->isSimple())
-            //   errs() << "   Simple Load  " << '\n';
-
-            InputData += Load->getType()->getPrimitiveSizeInBits();
-            ++NumberOfLoads;
-
-
-          }
-
-
-      }
-    }
-
-    errs() << " Loads " << NumberOfLoads ;
-
-      return InputData;
-    }
-
-    virtual int getInputDataLoop(Region *R, LoopInfo &LI, ScalarEvolution &SE, unsigned int NumberOfLoops, unsigned int NumberOfArrays) {
-
-      int InputData = 0;
-      int NumberOfLoads = 0;
-
-      int *LoopIterationsArray   = new int[NumberOfLoops] ();
-      std::string *ArrayRefNames = new std::string[NumberOfArrays] ();
-      int *ArrayLoads            = new int[NumberOfArrays] ();  // Could use std::vector instead.
+      // Indexed by Loop depth, which can exceed NumberOfLoops in a Region nested in Loops.
+      std::vector<int> LoopIterationsArray(NumberOfLoops);
+      std::vector<std::string> ArrayRefNames(NumberOfArrays);
+      std::vector<int> ArrayLoads(NumberOfArrays);
 
       int indexNamesArray = 0;
 
@@ -1157,6 +1049,9 @@ namespace {
             // Check Number Of Loops!
             if (NumberOfLoops>=1) {
 
+              if (loop_depth > LoopIterationsArray.size())
+                LoopIterationsArray.resize(loop_depth);
+
               LoopIterationsArray[loop_depth-1] = SE.getSmallConstantTripCount(L);
 
               // Load Info
@@ -1207,93 +1102,55 @@ namespace {
           }
         }
 
-        if (BBLoads && NumberOfArrays) {
+        if (BBLoads && NumberOfArrays && RS_VERBOSITY_AT_LEAST(RSV_Trace)) {
 
           // Print for Total Loads in a Basic Block.
-          errs() << "     Input Data for " << CurrentBlock->getName() << " is   :  " << BBLoads ;  
+          OS << "     Input Data for " << CurrentBlock->getName() << " is   :  " << BBLoads ;  
           if (NumberOfLoops>1) {
             for (unsigned int j=0; j<loop_depth; j++)
-              errs() << " X "  << LoopIterationsArray[j];
+              OS << " X "  << LoopIterationsArray[j];
           }
 
           else
-            errs() << " X "  << LoopIterationsArray[loop_depth-1];
+            OS << " X "  << LoopIterationsArray[loop_depth-1];
         
-          errs() << "\n\n";
+          OS << "\n\n";
 
           // Print for each Array separately.
           if (NumberOfLoops>=1) {
             for (unsigned int i=0; i<NumberOfArrays; i++) {
 
               if (ArrayLoads[i]) {
-                errs() << "     Input Data for Array "<< ArrayRefNames[i] << "  is   :  " << ArrayLoads[i];
+                OS << "     Input Data for Array "<< ArrayRefNames[i] << "  is   :  " << ArrayLoads[i];
 
                 if (NumberOfLoops==1)
-                  errs() << " X "  << LoopIterationsArray[loop_depth-1];
+                  OS << " X "  << LoopIterationsArray[loop_depth-1];
 
                 else
                   for (unsigned int j=0; j<loop_depth; j++)
-                    errs() << " X "  << LoopIterationsArray[j];
+                    OS << " X "  << LoopIterationsArray[j];
               
 
-                errs() << "\n";
+                OS << "\n";
               } 
             }           
           }        
-          errs() << "\n\n";
+          OS << "\n\n";
         }
       }
 
-      errs() << "     Loads                  :  " << NumberOfLoads << '\n';
-      errs() << "     Input Data is (Bytes)  :  " << InputData / 8 << "\n\n";
-
-      // Clean Up.
-      delete [] LoopIterationsArray;
-      delete [] ArrayRefNames;
-      delete [] ArrayLoads;
+      OS << "     Loads                  :  " << NumberOfLoads << '\n';
+      OS << "     Input Data is (Bytes)  :  " << InputData / 8 << "\n\n";
 
       return InputData;
     }
 
-     virtual int getOutputData(Region *R) {
-
-      int OutputData = 0;
-      int NumberOfStores = 0;
-
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
-        BasicBlock *CurrentBlock = *BB;
-
-        // Iterate inside the basic block.
-        for(BasicBlock::iterator BI = CurrentBlock->begin(), BE = CurrentBlock->end(); BI != BE; ++BI) {
-
-          ///if(Instruction *Inst = dyn_cast<Instruction>(&*BI)) {
-
-           // Do not consider Branch Instructions.
-           if (dyn_cast<BranchInst>(&*BI))
-            continue;
-
-            // Store Info
-            if(StoreInst *Store = dyn_cast<StoreInst>(&*BI)) {
-
-              OutputData += Store->getOperand(0)->getType()->getPrimitiveSizeInBits();
-              ++NumberOfStores;
-
-            }
-
-        }
-      }
 
-      errs() << " Stores " << NumberOfStores  ;
-  
-
-      return OutputData;
-    }
-
-    virtual int getOutputDataLoop(Region *R, LoopInfo &LI, ScalarEvolution &SE, unsigned int NumberOfLoops) {
+    virtual int getOutputDataLoop(Region *R, LoopInfo &LI, ScalarEvolution &SE, unsigned int NumberOfLoops, raw_ostream &OS) {
 
       int OutputData = 0;
       int NumberOfStores = 0;
-      int LoopIterationsArray[10]= {0};
+      std::vector<int> LoopIterationsArray(10); // Indexed by Loop depth, grown for deeper Loops.
       // std::vector<Loop *> Loops;
       // Loops.clear();
 
@@ -1310,6 +1167,9 @@ namespace {
             // Check Number Of Loops!
             if (NumberOfLoops>1) {
 
+              if (loop_depth > LoopIterationsArray.size())
+                LoopIterationsArray.resize(loop_depth);
+
               LoopIterationsArray[loop_depth-1] = SE.getSmallConstantTripCount(L);
 
               // Load Info
@@ -1351,171 +1211,13 @@ namespace {
         }
       }
 
-      errs() << "     Stores                  :  " << NumberOfStores << '\n';
-      errs() << "     Output Data is (Bytes)  :  " << OutputData / 8 << "\n\n";
+      OS << "     Stores                  :  " << NumberOfStores << '\n';
+      OS << "     Output Data is (Bytes)  :  " << OutputData / 8 << "\n\n";
 
       return OutputData;
     }
 
 
-    // @brief  Gather Output Data Flow for the region.
-    //
-    // @param  R    The Region for which we are gathering information.
-    //
-    // @return int  The number of output Data instances (instructions) of the Region.
-    virtual int gatherOutput(Region *R) {
-
-      auto *TLIP = getAnalysisIfAvailable<TargetLibraryInfoWrapperPass>();
-      TargetLibraryInfo *TLI = TLIP ? &TLIP->getTLI() : nullptr;
-      int Output_number = 0;
-      std::vector<Instruction *> ext_out; // Worklist for external output instructions.
-      ext_out.clear();
-
-      // Iterate over the Region's Basic Blocks.
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
-
-        // Iterate inside the basic block.
-        for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
-
-          if(Instruction *Inst = dyn_cast<Instruction>(&*BI)) {
-
-            // Do not consider Branch Instructions.
-            if (dyn_cast<BranchInst>(&*BI))
-              continue;
-
-            if (!isInstructionTriviallyDead(Inst, TLI)) {      
-
-              // Get the Users of the instruction.
-              for (User *U : Inst->users()) {
-
-                
-        
-                if (Instruction *User_Inst = dyn_cast<Instruction>(U)) {
-
-                  // If the User is not inside this Region then it is considered as output. 
-                  if (!(R->contains(User_Inst))) {
-
-                    if (Inst && find_inst(ext_out, Inst) == -1) {
-                      ext_out.push_back(Inst);
-                      ++Output_number;
-                      //errs()<< "    Output Instruction : " << "\t" << Inst->getName() << "\n";
-                    }
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-
-      //errs() << "\n   Output Alive Number is  : " << Output_number << "\n\n";
-      return Output_number;           
-    }
-
-
-    // @brief  Gather Input Data Flow for the region.
-    //
-    // @param  R    The Region for which we are gathering information.
-    //
-    // @return int  The number of Input Data instances (instructions) of the Region.
-    virtual int gatherInput(Region *R) {
-
-      auto *TLIP = getAnalysisIfAvailable<TargetLibraryInfoWrapperPass>();
-      TargetLibraryInfo *TLI = TLIP ? &TLIP->getTLI() : nullptr;
-      int Input_number  = 0;
-      std::vector<Value *> ext_in;
-      ext_in.clear();
-
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
-
-        // Iterate inside the basic block.
-        for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
-
-          if(Instruction *Inst = dyn_cast<Instruction>(&*BI)) {
-
-            // Do not consider Branch Instructions.
-            if (dyn_cast<BranchInst>(&*BI))
-              continue;
-
-            if (!isInstructionTriviallyDead(Inst, TLI)) {      
-
-              // Iterate over each operand of each Instruction.
-              for (unsigned int i=0; i<Inst->getNumOperands(); i++) {
-
-                Value *Operand = Inst->getOperand(i);
-
-                // Exclude operands that represent constants.(signed integers) 
-                if (Inst->getOperand(i)->getValueID() == 11)
-                  continue; 
-
-                // Iterate over all the instructions of the Region and compare the operand to them.
-                bool local = compareInstrToOperand(R, Inst->getOperand(i));
-
-                // Data Flow is incremented if the operand is not coming from a local Instruction.
-                if (!local && Operand) {
-
-                  if (find_op(ext_in, Operand) == -1) {
-                    ext_in.push_back(Operand);
-                    ++Input_number;
-                    //errs()<< "     Input Operand : " << "\t" << Inst->getOperand(i)->getName() << "\n";
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-
-      //errs() << "\n   Input  Alive Number is  : " << Input_number << "\n\n"; 
-      
-      DEBUG(errs() << "I am here!\n");
-      return Input_number;
-    }
-
-    // @brief  Compare Instructions of Basic Block to Operand.
-    //
-    // If the operand of a BB is not coming from a local instruction
-    // of the same BB, then it is being received by a predecessor BB. 
-    //
-    // @param @param  R  The Region for which we are gathering information.
-    //        Value The  Operand that we are comparing.
-    //        int   The  Data Flow Number that represents either the
-    //              input or the output value for the Region. 
-    //
-    // @return void
-    virtual bool compareInstrToOperand(Region *R, Value *Operand) {
-
-      bool local = false;
-
-      for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB) {
-
-        // Iterate inside the basic block.
-        for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
-
-          if(Instruction *Inst = dyn_cast<Instruction>(&*BI)) {
-
-            // Do not consider Branch Instructions.
-            if (dyn_cast<BranchInst>(&*BI))
-              continue;
-
-            // Compare Operand with Instructions in BB.   
-            // if (Operand->getName() != "") {
-            //   if (Operand->getName() == Inst->getName())
-            //     local = true;
-            // }
-            
-            else
-              if (Operand)
-                if (Operand == Inst)
-                  local = true;
-          }
-        }
-      }
-
-      return local;
-
-    }
-
     virtual unsigned int GatherNumberOfArrays(BasicBlock *BB, std::vector<Value *> ArrayReferences) {
 
       unsigned int NumberOfArrays = 0;
@@ -1546,13 +1248,11 @@ namespace {
       return NumberOfArrays;
     }
 
-    int getEntryCount(Function *F) {
+    int64_t getEntryCount(Function *F) {
 
-      int entry_freq = 0;
+      int64_t entry_freq = 0;
 
-      if (F->hasMetadata()) {
-
-        MDNode *node = F->getMetadata("prof");
+      if (MDNode *node = F->getMetadata("prof")) {
 
         if (MDString::classof(node->getOperand(0))) {
           auto mds = cast<MDString>(node->getOperand(0));
@@ -1587,3 +1287,4 @@ namespace {
 
 char IdentifyRegions::ID = 0;
 static RegisterPass<IdentifyRegions> X("IdentifyRegions", "Identify Valid Regions");
+
@@ -22,38 +22,94 @@ using namespace llvm;
 std::ofstream region_info_latex; // File that Region Info are written.
 
 namespace {
-  int find_bb_name(std::vector<BasicBlock *> list, BasicBlock *BB) {
 
-      for (unsigned i = 0; i < list.size(); i++)
-        if (list[i]->getName() == BB->getName())
-          return i;
-      
-    
-    return -1;
+  // Opens File once for appending, with a buffer large enough that records
+  // reach the disk in a few large writes rather than one write per record.
+  //
+  // @return  false if the file could not be opened.
+  bool openResultFile(std::ofstream &File, std::vector<char> &Buffer, const std::string &Dir,
+                      const std::string &Prefix, const std::string &Name,
+                      std::ios_base::openmode Mode = std::ofstream::out | std::ofstream::app) {
+
+    SmallString<128> Path(Dir);
+    sys::path::append(Path, Prefix + Name);
+
+    Buffer.resize(1 << 20);
+    File.rdbuf()->pubsetbuf(Buffer.data(), Buffer.size());
+    File.open(Path.c_str(), Mode);
+
+    return File.is_open();
   }
 
+  // The output files of the pass: Regions.txt, Regions_raw.txt and
+  // Region_info_latex.txt, named Dir/<Prefix><Name>. They are open for the
+  // whole Module and flushed when it is done. The same Regions are collected
+  // in Binary and appended to Regions.bin as one chunk per Module. With
+  // -rs-save-snapshots the RegionGraph of every Function is appended to
+  // Snapshots.rg as well, and with -rs-configs the Speedups of every
+  // configuration to Regions_configs.txt.
+  struct ResultFiles {
 
-  // int find_inst(std::vector<Instruction *> list, Instruction *inst) { // Remove it since there is in IdentifyRegions.h
+    std::vector<char> Buffers[5];
+    RegionResultsWriter Binary;
+    std::string BinaryPath;
+    std::ofstream Snapshots;
+    std::ofstream Configs;
 
-  //     for (unsigned i = 0; i < list.size(); i++)
-  //       if (list[i] == inst)
-  //         return i;
-      
-    
-  //   return -1;
-  // }
+    bool open(const std::string &Dir, const std::string &Prefix, bool SaveSnapshots, bool SaveConfigs) {
 
-  int find_op(std::vector<Value *> list, Value *op) {
+      if (sys::fs::create_directories(Dir))
+        return false;
 
-      for (unsigned i = 0; i < list.size(); i++) 
-        if (list[i] == op)
-          return i;
-      
-    
-    return -1;
-  }
+      SmallString<128> Path(Dir);
+      sys::path::append(Path, Prefix + "Regions.bin");
+      BinaryPath = Path.str().str();
+      Binary.clear();
+
+      if (SaveSnapshots &&
+          !openResultFile(Snapshots, Buffers[3], Dir, Prefix, "Snapshots.rg",
+                          std::ofstream::out | std::ofstream::app | std::ofstream::binary))
+        return false;
+
+      if (SaveConfigs && !openResultFile(Configs, Buffers[4], Dir, Prefix, "Regions_configs.txt"))
+        return false;
+
+      return openResultFile(myfile, Buffers[0], Dir, Prefix, "Regions.txt") &&
+             openResultFile(myrawfile, Buffers[1], Dir, Prefix, "Regions_raw.txt") &&
+             openResultFile(region_info_latex, Buffers[2], Dir, Prefix, "Region_info_latex.txt");
+    }
+
+    void saveSnapshot(const RegionGraph &G) {
+
+      if (!Snapshots.is_open())
+        return;
+
+      std::string Chunk;
+      RegionGraphWriter(Chunk).write(G);
+      Snapshots.write(Chunk.data(), Chunk.size());
+    }
+
+    // @return  false if Regions.bin or Snapshots.rg could not be written.
+    bool close() {
+
+      myfile.close();
+      myrawfile.close();
+      region_info_latex.close();
+
+      if (Configs.is_open())
+        Configs.close();
 
-  int find_array(std::vector<Value *> ArrayReferences, Value *ArrayRef) {
+      bool SnapshotsWritten = true;
+      if (Snapshots.is_open()) {
+        Snapshots.close();
+        SnapshotsWritten = !Snapshots.fail();
+      }
+
+      return (Binary.empty() || Binary.append(BinaryPath)) && SnapshotsWritten;
+    }
+  };
+
+  int find_array(const std::vector<Value *> &ArrayReferences, Value *ArrayRef) {
 
     for (unsigned i = 0; i < ArrayReferences.size(); i++) 
       if (ArrayReferences[i] == ArrayRef)
@@ -63,28 +119,42 @@ namespace {
     return -1;
   }
 
-  int find_region(std::vector<Region *> list, Region *Reg) {
+  // Gather the Regions of the Region tree rooted at Top in pre-order, so that a
+  // Region comes before its sub-Regions, visiting each Region exactly once.
+  // Only Regions with MinDepth <= depth <= MaxDepth are gathered; Top is at
+  // depth 0 when it is the top level Region of the Function.
+  void getRegionsOfTree(Region *Top, unsigned MinDepth, unsigned MaxDepth, std::vector<Region *> &Regions) {
 
-    for (unsigned i = 0; i < list.size(); i++)
-      if (list[i] == Reg)
-        return i;
-      
-    
-    return -1;
-  }
-    
+    std::vector<std::pair<Region *, unsigned> > Worklist;
+    Worklist.push_back(std::make_pair(Top, Top->getDepth()));
 
-  // int find_bb(std::vector<BasicBlock *> list, BasicBlock *BB) {
+    while (!Worklist.empty()) {
 
-  //   for (unsigned i = 0; i < list.size(); i++)
-  //     if (list[i] == BB)
-  //       return i;
-      
-    
-  //   return -1;
-  // }
+      Region *R      = Worklist.back().first;
+      unsigned Depth = Worklist.back().second;
+      Worklist.pop_back();
+
+      if (Depth >= MinDepth)
+        Regions.push_back(R);
+
+      if (Depth == MaxDepth)
+        continue;
 
+      // Push the sub-Regions in reverse, so that they are visited in order.
+      unsigned First = Worklist.size();
 
+      for (Region::iterator SubR = R->begin(), E = R->end(); SubR != E; ++SubR)
+        Worklist.push_back(std::make_pair(SubR->get(), Depth + 1));
+
+      std::reverse(Worklist.begin() + First, Worklist.end());
+    }
+  }
+
+  // Size of a Value of type Ty in bits. Labels, void and other unsized types have none.
+  uint64_t getSizeInBits(Type *Ty, const DataLayout &DL) {
+
+    return Ty->isSized() ? static_cast<uint64_t>(DL.getTypeSizeInBits(Ty)) : 0;
+  }
 
   bool printBasicBlock(Region::block_iterator &BB) {
 
@@ -93,164 +163,243 @@ namespace {
     return false;
   }
 
-  // Returns true if Block iterator of Region contains no Call Instructions.
-  //
-  bool isBBCallFree(Region::block_iterator &BB) {
+  // Frequency of BB as annotated in the "freq" metadata of its terminator, 0 if none.
+  int64_t getAnnotatedFreqOfBB(BasicBlock *BB) {
+
+    int64_t freq = 0;
+
+    if (MDNode *node = BB->getTerminator()->getMetadata("freq")) {
+
+      if (MDString::classof(node->getOperand(0))) {
+        auto mds = cast<MDString>(node->getOperand(0));
+        if (mds->getString().trim().getAsInteger(10, freq))
+          freq = 0;
+      }
 
-    // Iterate inside the basic block.
-    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI){
-       if(dyn_cast<CallInst>(&*BI))
-        return false;
     }
 
-    return true;
+    return freq;
   }
 
-  // Region Function - Might remove it.
-  //
-  bool runOnBasicBlock(Region::block_iterator &BB, unsigned int *DFGNodesRegion, unsigned int *GoodDFGNodesRegion, unsigned int *OptimalityRegion) {
+  // Lower F into the RegionGraph G: its Instructions as the cost model sees
+  // them, its CFG, Loop nest, Region tree and the Frequencies of its BBs.
+  // Everything the Regions are costed on is taken from G afterwards.
+  // RegionNumbers maps every Region of RI to its number in G.
+  void lowerFunction(Function &F, RegionInfo &RI, LoopInfo &LI, BlockFrequencyInfo &BFI, ScalarEvolution &SE,
+                     const TargetLibraryInfo *TLI, int64_t EntryCount, RegionGraph &G,
+                     DenseMap<const Region *, unsigned> &RegionNumbers) {
 
-      unsigned int GoodDFGNodesBB = 0;
-      unsigned int GoodnessBB = 0;
-      int32_t freq = 0; 
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    double EntryFreq = static_cast<double>(BFI.getEntryFreq());
+    DenseMap<const Value *, int32_t> ValueNumbers;
+    DenseMap<const BasicBlock *, unsigned> BlockNumbers;
+    DenseMap<const Loop *, int32_t> LoopNumbers;
 
-      // Iterate inside the basic block.
-      for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
-        
-        *DFGNodesRegion = *DFGNodesRegion + 1;
+    G.clear();
+    RegionNumbers.clear();
+    G.Name = F.getName().str();
+    G.EntryCount = EntryCount;
 
-        if (!isMarked(&*BI)) {
-          *GoodDFGNodesRegion = *GoodDFGNodesRegion + 1;
-          GoodDFGNodesBB++;
-        }
-      }
+    // Number Blocks and Instructions up front, operands may refer forward.
+    int32_t NumInsts = 0;
 
-      if (MDNode *node = BB->getTerminator()->getMetadata("freq")) {
+    for(Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
 
-        if (MDString::classof(node->getOperand(0))) {
-          auto mds = cast<MDString>(node->getOperand(0));
-          std::string metadata_str = mds->getString();
-          freq = std::stoi(metadata_str);
-        }
+      BlockNumbers[&*BB] = G.BlockNames.size();
+      G.BlockNames.push_back(BB->getName().str());
 
-      }
+      for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
+        ValueNumbers[&*BI] = NumInsts++;
+    }
 
-      GoodnessBB = GoodDFGNodesBB * freq ;
-      *OptimalityRegion = *OptimalityRegion + GoodnessBB; // Density
+    // Loops, parents before their sub-Loops.
+    std::vector<Loop *> Worklist(LI.begin(), LI.end());
 
-      // errs() << "     Good Nodes of BB are\t:\t" << GoodDFGNodesBB << " \n";
-      // errs() << "     Frequency of BB is  \t:\t" << freq << " \n";
-      // errs() << "     Goodness of BB is   \t:\t" << GoodnessBB << " \n\n";
-      
-      //++BBCounter;
-      return false;
-  }
+    while (!Worklist.empty()) {
 
-  // Get Area Estimation for a Block iterator of a Region.
-  unsigned int getAreaOfBB(Region::block_iterator &BB) {
+      Loop *L = Worklist.back();
+      Worklist.pop_back();
 
-    unsigned int AreaOfBB = 0;
+      LoopNumbers[L] = G.LoopParent.size();
+      G.LoopParent.push_back(L->getParentLoop() ? LoopNumbers[L->getParentLoop()] : -1);
+      G.LoopHeader.push_back(BlockNumbers[L->getHeader()]);
+      G.LoopDepth.push_back(L->getLoopDepth());
+      G.LoopTripCount.push_back(SE.getSmallConstantTripCount(L));
 
-    // Iterate inside the basic block.
-    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
-      AreaOfBB += getAreaEstim(&*BI);
+      Worklist.insert(Worklist.end(), L->begin(), L->end());
+    }
 
-    return AreaOfBB;
-  }
+    // Regions in pre-order.
+    std::vector<Region *> Regions;
+    getRegionsOfTree(RI.getTopLevelRegion(), 0, ~0U, Regions);
 
-  // Get the Area extimation of a Region in LUTs.
-  unsigned int getAreaofRegion(Region *R){
+    for (unsigned i = 0; i < Regions.size(); i++) {
 
-    unsigned int AreaOfRegion = 0;
+      Region *R = Regions[i];
 
-    for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB)
-      AreaOfRegion += getAreaOfBB(BB);
+      RegionNumbers[R] = i;
+      G.RegionParent.push_back(R->getParent() ? static_cast<int32_t>(RegionNumbers[R->getParent()]) : -1);
+      G.RegionEnd.push_back(i + 1);
+      G.RegionEntry.push_back(BlockNumbers[R->getEntry()]);
+      G.RegionExit.push_back(R->getExit() ? static_cast<int32_t>(BlockNumbers[R->getExit()]) : -1);
+      G.RegionDepth.push_back(R->getDepth());
+    }
 
-    return AreaOfRegion;
+    for (unsigned i = Regions.size(); i-- > 1; )
+      G.RegionEnd[G.RegionParent[i]] = std::max(G.RegionEnd[G.RegionParent[i]], G.RegionEnd[i]);
 
-  }
+    // Blocks and their Instructions.
+    for(Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
 
-  
-  // Region Function - Might remove it.
-  //
-  bool getGoodnessAndDensityOfRegionInBB(Region::block_iterator &BB, unsigned int *DFGNodesRegion, unsigned int *GoodDFGNodesRegion, unsigned int *OptimalityRegion) {
+      G.InstBegin.push_back(G.getNumInsts());
 
-    unsigned int GoodDFGNodesBB = 0;
-    unsigned int GoodnessBB = 0;
-    int32_t freq = 0; 
+      for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
 
-    // Iterate inside the basic block.
-    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
-      
-      *DFGNodesRegion = *DFGNodesRegion + 1;
+        Instruction *Inst = &*BI;
+        PHINode *phi = dyn_cast<PHINode>(Inst);
 
-      if (!isMarked(&*BI)) {
-        *GoodDFGNodesRegion = *GoodDFGNodesRegion + 1;
-        GoodDFGNodesBB++;
-      }
-    }
+        G.Opcode.push_back(getRGOpcode(Inst));
+        G.Aux.push_back(getRGAux(Inst));
+        G.Bits.push_back(getSizeInBits(Inst->getType(), DL));
+        G.Flags.push_back(isInstructionTriviallyDead(Inst, TLI) ? RGF_TriviallyDead : 0);
+        G.OperandBegin.push_back(G.Operands.size());
 
-    if (MDNode *node = BB->getTerminator()->getMetadata("freq")) {
+        for (unsigned int i=0; i<Inst->getNumOperands(); i++) {
 
-      if (MDString::classof(node->getOperand(0))) {
-        auto mds = cast<MDString>(node->getOperand(0));
-        std::string metadata_str = mds->getString();
-        freq = std::stoi(metadata_str);
+          Value *Operand = Inst->getOperand(i);
+
+          G.OperandBlocks.push_back(phi ? static_cast<int32_t>(BlockNumbers[phi->getIncomingBlock(i)]) : -1);
+
+          // Exclude operands that represent constants.(signed integers)
+          if (Operand->getValueID() == 11) {
+            G.Operands.push_back(-1);
+            continue;
+          }
+
+          DenseMap<const Value *, int32_t>::iterator It = ValueNumbers.find(Operand);
+
+          if (It == ValueNumbers.end()) {
+            It = ValueNumbers.insert(std::make_pair(Operand, NumInsts + static_cast<int32_t>(G.ExternalBits.size()))).first;
+            G.ExternalBits.push_back(getSizeInBits(Operand->getType(), DL));
+          }
+
+          G.Operands.push_back(It->second);
+        }
       }
 
+      G.SuccBegin.push_back(G.Succs.size());
+      for (succ_iterator SI = succ_begin(&*BB), SuccEnd = succ_end(&*BB); SI != SuccEnd; ++SI)
+        G.Succs.push_back(BlockNumbers[*SI]);
+
+      G.PredBegin.push_back(G.Preds.size());
+      for (pred_iterator PI = pred_begin(&*BB), PE = pred_end(&*BB); PI != PE; ++PI)
+        G.Preds.push_back(BlockNumbers[*PI]);
+
+      Loop *L = LI.getLoopFor(&*BB);
+      G.BlockLoop.push_back(L ? LoopNumbers[L] : -1);
+
+      Region *R = RI.getRegionFor(&*BB);
+      G.BlockRegion.push_back(R ? static_cast<int32_t>(RegionNumbers[R]) : -1);
+
+      double Freq = static_cast<double>(BFI.getBlockFreq(&*BB).getFrequency()) / EntryFreq;
+
+      G.FreqPerIter.push_back(Freq);
+      G.FreqTotal.push_back(Freq * static_cast<double>(EntryCount));
+      G.FreqAnnotated.push_back(static_cast<double>(getAnnotatedFreqOfBB(&*BB)));
     }
 
-    GoodnessBB = GoodDFGNodesBB * freq ;
-    *OptimalityRegion = *OptimalityRegion + GoodnessBB; 
-    
-    return false;
+    G.InstBegin.push_back(G.getNumInsts());
+    G.OperandBegin.push_back(G.Operands.size());
+    G.SuccBegin.push_back(G.Succs.size());
+    G.PredBegin.push_back(G.Preds.size());
+
+    G.buildUsers();
   }
 
-  // Gather the number of BBs in a Region.
-  unsigned int getBBsOfRegion(Region *R) {
+  // Gather the number of Loops in a Region.
+  unsigned int getLoopsOfRegion(const RegionGraph &G, const ScratchVector<unsigned> &Blocks) {
 
-    unsigned int BBsofRegion=0;
+    ScratchScope Scope;
+    ScratchVector<int32_t> Loops;
 
-    for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB)
-      BBsofRegion++;
+    for (unsigned b = 0; b < Blocks.size(); b++)
+      if (G.BlockLoop[Blocks[b]] >= 0)
+        Loops.push_back(G.BlockLoop[Blocks[b]]);
 
-    return BBsofRegion;
+    std::sort(Loops.begin(), Loops.end());
+    return std::unique(Loops.begin(), Loops.end()) - Loops.begin();
   }
 
+  // CallFree of every Region of G, as in RegionMetrics but without measuring
+  // the BBs, for checks that are made before the Regions are costed.
+  void getCallFreeRegions(const RegionGraph &G, std::vector<bool> &CallFree) {
 
-  // Gather the number of DFG Nodes in a Region.
-  unsigned int getDFGNodesOfRegion(Region *R) {
+    CallFree.assign(G.getNumRegions(), true);
 
-    unsigned int DFGNodes=0;
+    for (unsigned B = 0; B < G.getNumBlocks(); B++) {
 
-    for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB){
+      if (G.BlockRegion[B] < 0)
+        continue;
 
-      for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
-        DFGNodes++;
+      for (unsigned I = G.InstBegin[B]; I < G.InstBegin[B+1]; I++)
+        if (G.getOpcode(I) == RG_Call)
+          CallFree[G.BlockRegion[B]] = false;
     }
 
-    return DFGNodes;
+    for (unsigned R = G.getNumRegions(); R-- > 1; )
+      if (!CallFree[R])
+        CallFree[G.RegionParent[R]] = false;
   }
 
-  // Gather the number of Loops in a Region.
-  unsigned int getLoopsOfRegion(Region *R, LoopInfo &LI) {
+  // getCostsOfRegion for every configuration of Configs. The CFG, its
+  // topological order and the Frequency of the Region do not depend on the
+  // configuration and are computed once.
+  //
+  // @param  Blocks  The Blocks of Region R, from getBlocksOfRegion.
+  void getConfigCostsOfRegion(const RegionGraph &G, unsigned R, const ScratchVector<unsigned> &Blocks,
+                              ConfigMetricsTable &Configs, RegionConfigCosts &Costs) {
 
-    unsigned int NumberOfLoops=0;
-    std::vector<Loop *> Loops;
-    Loops.clear();
+    unsigned N = Configs.size();
+    RegionCFG CFG(G, Blocks);
+    double Freq = getRegionTotalFreq(G, R);
+    ScratchVector<long int> HWCostBB(Blocks.size() * N), HWCostPath;
+    ScratchVector<int64_t> SWCost(N, 0);
 
-    for(Region::block_iterator BB = R->block_begin(), E = R->block_end(); BB != E; ++BB){
+    for (unsigned i = 0; i < Blocks.size(); i++) {
 
-      if (Loop *L = LI.getLoopFor(*BB)){
+      const long int *HW = Configs.getHWCost(Blocks[i]);
+      const int64_t *SW = Configs.getSWCost(Blocks[i]);
 
-      if (find_loop(Loops, L) == -1 ){ 
-          Loops.push_back(L);
-          NumberOfLoops++;
-        }
-      }
+      std::copy(HW, HW + N, &HWCostBB[i * N]);
+
+      for (unsigned c = 0; c < N; c++)
+        SWCost[c] += SW[c];
     }
 
-    return NumberOfLoops;
+    getCriticalPathsOfRegion(CFG, N, HWCostBB, HWCostPath, Costs.HWCost);
+
+    Costs.SWCost.assign(SWCost.begin(), SWCost.end());
+    Costs.Overhead.resize(N);
+    Costs.Speedup.resize(N);
+
+    for (unsigned c = 0; c < N; c++) {
+      Costs.Overhead[c] = static_cast<long int> (Freq * Configs.getModel(c).CallOverhead);
+      Costs.Speedup[c]  = Costs.SWCost[c] - Costs.HWCost[c] - Costs.Overhead[c];
+    }
+  }
+
+  // Dynamic Instructions of every Region of G: the Instructions of its BBs,
+  // weighted by their total Frequencies. Region 0 has those of the Function.
+  void getDynamicInstsOfRegions(const RegionGraph &G, std::vector<double> &DynInsts) {
+
+    DynInsts.assign(G.getNumRegions(), 0);
+
+    for (unsigned B = 0; B < G.getNumBlocks(); B++)
+      if (G.BlockRegion[B] >= 0)
+        DynInsts[G.BlockRegion[B]] += G.FreqTotal[B] * (G.InstBegin[B+1] - G.InstBegin[B]);
+
+    for (unsigned R = G.getNumRegions(); R-- > 1; )
+      DynInsts[G.RegionParent[R]] += DynInsts[R];
   }
 
 }
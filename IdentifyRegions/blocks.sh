@@ -0,0 +1,94 @@
+#!/bin/bash
+#
+# Times IdentifyRegions on a synthetic Function of many BBs, the case where
+# any per-Region or per-BB lookup that is linear in the Function shows up.
+#
+#   IdentifyRegions/blocks.sh <IdentifyRegions.so>...
+#
+# e.g. IdentifyRegions/blocks.sh old/IdentifyRegions.so IdentifyRegions.so
+#
+# The Function is a chain of if-then-else Regions of BODY Instructions per
+# BB, 4 BBs each, BLOCKS BBs in all (default 8000). Each build of the pass
+# given is run on it in turn: the script prints the wall-clock seconds of
+# each and fails if their Regions_raw.txt differ. OPT (default opt) is the
+# opt to run.
+
+if [ $# -lt 1 ]; then
+  echo "usage: $0 <IdentifyRegions.so>..." >&2
+  exit 2
+fi
+
+OPT=${OPT:-opt}
+BLOCKS=${BLOCKS:-8000}
+BODY=${BODY:-4}
+
+TIMEFORMAT=%R
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+awk -v K=$((BLOCKS / 4)) -v N="$BODY" '
+  function body(B,   i, prev) {
+    prev = "%a"
+    for (i = 0; i < N; i++) {
+      printf "  %%%s.%d = %s i32 %s, %%b\n", B, i, Ops[i % 5], prev
+      prev = "%" B "." i
+    }
+    printf "  %%%s.p = getelementptr inbounds i32, i32* %%arr, i32 %d\n", B, Index++
+    printf "  store i32 %s, i32* %%%s.p\n", prev, B
+    return prev
+  }
+  BEGIN {
+    split("add mul xor sub shl", Ops, " ")
+    Ops[0] = Ops[5]
+    print "define void @blocks(i32 %a, i32 %b, i32* %arr) !prof !1 {"
+    print "entry:\n  br label %d0, !freq !0"
+    for (k = 0; k < K; k++) {
+      printf "d%d:\n", k
+      v = body("d" k)
+      printf "  %%d%d.c = icmp slt i32 %s, %d\n", k, v, k
+      printf "  br i1 %%d%d.c, label %%t%d, label %%e%d, !freq !0\n", k, k, k
+      printf "t%d:\n", k
+      body("t" k)
+      printf "  br label %%j%d, !freq !0\n", k
+      printf "e%d:\n", k
+      body("e" k)
+      printf "  br label %%j%d, !freq !0\n", k
+      printf "j%d:\n", k
+      body("j" k)
+      printf "  br label %%%s, !freq !0\n", k + 1 < K ? "d" (k + 1) : "exit"
+    }
+    print "exit:\n  ret void, !freq !0\n}\n"
+    print "!0 = !{!\"1000\"}\n!1 = !{!\"function_entry_count\", i64 10}"
+  }' > "$WORK/blocks.ll" || exit 1
+
+REFERENCE=
+STATUS=0
+i=0
+
+for PASS in "$@"; do
+
+  PASS=$(cd "$(dirname "$PASS")" && pwd)/$(basename "$PASS")
+
+  DIR="$WORK/$i"
+  mkdir -p "$DIR"
+
+  # Builds of any age write their Region files to the working directory and
+  # take no options, so the pass is run in DIR with none.
+  if ! TIME=$( cd "$DIR" && { time $OPT -load "$PASS" -IdentifyRegions -disable-output \
+                                "$WORK/blocks.ll" > stdout 2> stderr; } 2>&1 ); then
+    cat "$DIR/stderr" >&2
+    exit 1
+  fi
+
+  if [ -z "$REFERENCE" ]; then
+    REFERENCE=$DIR
+  elif ! cmp -s "$REFERENCE/Regions_raw.txt" "$DIR/Regions_raw.txt"; then
+    echo "Regions_raw.txt of $PASS differs from that of $1" >&2
+    STATUS=1
+  fi
+
+  printf "%8.2f s  %s\n" $TIME "$PASS"
+  i=$((i + 1))
+done
+
+exit $STATUS
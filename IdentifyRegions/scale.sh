@@ -0,0 +1,124 @@
+#!/bin/bash
+#
+# Measures how IdentifyRegions scales with -rs-threads on a synthetic Module
+# and checks that the Region files do not depend on the number of threads.
+#
+#   IdentifyRegions/scale.sh <IdentifyRegions.so> [functions] [threads...]
+#
+# e.g. IdentifyRegions/scale.sh IdentifyRegions.so 2000 1 2 4 8 16
+#
+# Every Function of the Module is a loop around a nest of DEPTH if-then-else
+# Regions of BODY Instructions per BB. Parsing and the LLVM analyses stay on
+# one thread whatever -rs-threads says; they are timed first, with
+# -rs-coverage=0 so that no Function is snapshotted or costed, and taken out
+# of the speedup. The snapshots, also taken on one thread, are left in.
+#
+# The run with the first thread count is the reference: for each count the
+# script prints the wall-clock seconds and the speedup of the rest over the
+# reference, and fails if Regions_raw.txt or Regions.bin differ from it.
+# OPT (default opt) is the opt to run.
+
+if [ $# -lt 1 ]; then
+  echo "usage: $0 <IdentifyRegions.so> [functions] [threads...]" >&2
+  exit 2
+fi
+
+PASS=$1
+FUNCTIONS=${2:-2000}
+shift; shift
+THREADS=${@:-1 2 4 8}
+OPT=${OPT:-opt}
+DEPTH=${DEPTH:-48}
+BODY=${BODY:-4}
+
+TIMEFORMAT=%R
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+awk -v F="$FUNCTIONS" -v D="$DEPTH" -v N="$BODY" '
+  function body(B,   i, prev) {
+    prev = "%a"
+    for (i = 0; i < N; i++) {
+      printf "  %%%s.%d = %s i32 %s, %%b\n", B, i, Ops[i % 5], prev
+      prev = "%" B "." i
+    }
+    printf "  %%%s.p = getelementptr inbounds i32, i32* %%arr, i32 %%iv\n", B
+    printf "  store i32 %s, i32* %%%s.p\n", prev, B
+    return prev
+  }
+  BEGIN {
+    split("add mul xor sub shl", Ops, " ")
+    Ops[0] = Ops[5]
+    for (f = 0; f < F; f++) {
+      printf "define void @fn%d(i32 %%a, i32 %%b, i32 %%n, i32* %%arr) !prof !1 {\n", f
+      print "entry:\n  br label %loop, !freq !0"
+      print "loop:\n  %iv = phi i32 [ 0, %entry ], [ %ivn, %latch ]\n  br label %d0, !freq !0"
+      for (k = 0; k < D; k++) {
+        printf "d%d:\n", k
+        v = body("d" k)
+        printf "  %%d%d.c = icmp slt i32 %s, %d\n", k, v, k
+        printf "  br i1 %%d%d.c, label %%t%d, label %%e%d, !freq !0\n", k, k, k
+        printf "t%d:\n", k
+        body("t" k)
+        printf "  br label %%d%d, !freq !0\n", k + 1
+        printf "e%d:\n", k
+        body("e" k)
+        printf "  br label %%j%d, !freq !0\n", k
+      }
+      printf "d%d:\n", D
+      body("d" D)
+      printf "  br label %%j%d, !freq !0\n", D - 1
+      for (k = D - 1; k >= 0; k--) {
+        printf "j%d:\n", k
+        body("j" k)
+        printf "  br label %%%s, !freq !0\n", k ? "j" (k - 1) : "latch"
+      }
+      print "latch:\n  %ivn = add nsw i32 %iv, 1\n  %c = icmp slt i32 %ivn, %n"
+      print "  br i1 %c, label %loop, label %exit, !freq !0\nexit:\n  ret void, !freq !0\n}\n"
+    }
+    print "!0 = !{!\"1000\"}\n!1 = !{!\"function_entry_count\", i64 10}"
+  }' > "$WORK/scale.ll" || exit 1
+
+# @param  $1  The output directory, then the options of the run.
+# Sets TIME to its wall-clock seconds.
+run() {
+
+  local DIR=$1
+  shift
+  mkdir -p "$DIR"
+
+  if ! TIME=$( { time $OPT -load "$PASS" -IdentifyRegions -rs-verbosity=quiet "$@" \
+                   -rs-output-dir="$DIR" -disable-output "$WORK/scale.ll" 2> "$DIR/stderr"; } 2>&1 ); then
+    cat "$DIR/stderr" >&2
+    exit 1
+  fi
+}
+
+run "$WORK/analyses" -rs-coverage=0
+ANALYSES_TIME=$TIME
+echo "analyses $ANALYSES_TIME s"
+
+REFERENCE=
+STATUS=0
+
+for n in $THREADS; do
+
+  run "$WORK/$n" -rs-threads=$n
+
+  if [ -z "$REFERENCE" ]; then
+    REFERENCE=$n
+    REFERENCE_TIME=$TIME
+  else
+    for f in Regions_raw.txt Regions.bin; do
+      if ! cmp -s "$WORK/$REFERENCE/$f" "$WORK/$n/$f"; then
+        echo "$f differs between $REFERENCE and $n threads" >&2
+        STATUS=1
+      fi
+    done
+  fi
+
+  awk -v n=$n -v t=$TIME -v r=$REFERENCE_TIME -v a=$ANALYSES_TIME \
+    'BEGIN { printf "%3d threads %8.2f s  speedup %5.2f\n", n, t, (t > a ? (r - a) / (t - a) : 0) }'
+done
+
+exit $STATUS
@@ -0,0 +1,237 @@
+//===---------------------------- RegionCost.cpp ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Costs the Regions of RegionGraph snapshots, as saved by
+//
+//   opt -load IdentifyRegions.so -IdentifyRegions -rs-save-snapshots ...
+//
+// without LLVM: the same cost model and costing as the pass, on the saved
+// graphs. The valid Regions are written in the format of Regions_raw.txt
+// and, optionally, of Regions.bin.
+//
+//   RegionCost [-o <file>] [-bin <file>] [-min-depth <n>] [-max-depth <n>]
+//              [-max-blocks <n>] [-max-nodes <n>] [-min-freq <f>]
+//              [-max-inputs <n>] [-max-outputs <n>]
+//              [-cost-model <name|file>] <Snapshots.rg>...
+//
+// The limits are those of the -rs-max-blocks etc. options of the pass, with
+// the same defaults.
+//
+// -cost-model picks the cost model as -rs-cost-model does in the pass, and
+// RegionCost -print-cost-model [-cost-model <name|file>] prints it in the
+// format of a cost model file, as a starting point for a new one.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../RegionGraph.h"
+#include "../RegionResults.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+  struct Options {
+
+    std::string Output;                 // Regions_raw.txt format, stdout if empty.
+    std::string Binary;                 // Regions.bin format, not written if empty.
+    unsigned MinDepth;
+    unsigned MaxDepth;
+    RegionLimits Limits;
+    std::string Model;                  // Built-in cost model or cost model file.
+    bool PrintModel;
+    std::vector<std::string> Inputs;
+
+    Options() : MinDepth(0), MaxDepth(~0U), Model("sys-aware"), PrintModel(false) {
+
+      Limits.MaxInputs  = 100;
+      Limits.MaxOutputs = 100;
+    }
+  };
+
+  void printUsage(const char *Argv0) {
+
+    std::cerr << "usage: " << Argv0 << " [-o <file>] [-bin <file>] [-min-depth <n>] [-max-depth <n>]"
+              << " [-max-blocks <n>] [-max-nodes <n>] [-min-freq <f>] [-max-inputs <n>] [-max-outputs <n>]"
+              << " [-cost-model <name|file>] <Snapshots.rg>...\n"
+              << "       " << Argv0 << " -print-cost-model [-cost-model <name|file>]\n";
+  }
+
+  // @return  false if the command line is malformed.
+  bool parseOptions(int argc, char **argv, Options &Opts) {
+
+    for (int i = 1; i < argc; i++) {
+
+      std::string Arg = argv[i];
+      bool HasValue = i + 1 < argc;
+
+      if (Arg == "-o" && HasValue)
+        Opts.Output = argv[++i];
+      else if (Arg == "-bin" && HasValue)
+        Opts.Binary = argv[++i];
+      else if (Arg == "-min-depth" && HasValue)
+        Opts.MinDepth = std::strtoul(argv[++i], nullptr, 10);
+      else if (Arg == "-max-depth" && HasValue)
+        Opts.MaxDepth = std::strtoul(argv[++i], nullptr, 10);
+      else if (Arg == "-max-blocks" && HasValue)
+        Opts.Limits.MaxBlocks = std::strtoul(argv[++i], nullptr, 10);
+      else if (Arg == "-max-nodes" && HasValue)
+        Opts.Limits.MaxNodes = std::strtoul(argv[++i], nullptr, 10);
+      else if (Arg == "-min-freq" && HasValue)
+        Opts.Limits.MinFreq = std::strtod(argv[++i], nullptr);
+      else if (Arg == "-max-inputs" && HasValue)
+        Opts.Limits.MaxInputs = std::strtoul(argv[++i], nullptr, 10);
+      else if (Arg == "-max-outputs" && HasValue)
+        Opts.Limits.MaxOutputs = std::strtoul(argv[++i], nullptr, 10);
+      else if (Arg == "-cost-model" && HasValue)
+        Opts.Model = argv[++i];
+      else if (Arg == "-print-cost-model")
+        Opts.PrintModel = true;
+      else if (!Arg.empty() && Arg[0] != '-')
+        Opts.Inputs.push_back(Arg);
+      else
+        return false;
+    }
+
+    return Opts.PrintModel || !Opts.Inputs.empty();
+  }
+
+  // Cost the valid Regions of G, in pre-order, like the IdentifyRegions pass does.
+  void costFunction(const RegionGraph &G, const Options &Opts, const CostModel &Model, std::ostream &Raw,
+                    RegionResultsWriter &Binary) {
+
+    BlockMetricsTable BBMetrics;
+    RegionMetricsTree RegMetrics;
+    std::vector<int32_t> Rows(G.getNumRegions(), -1);
+
+    BBMetrics.reset(G, Model);
+    RegMetrics.build(G, BBMetrics);
+    Binary.beginFunction(G.Name);
+
+    for (unsigned R = 0; R < G.getNumRegions(); R++) {
+
+      if (G.RegionDepth[R] < Opts.MinDepth || G.RegionDepth[R] > Opts.MaxDepth)
+        continue;
+
+      // The scratch storage of the Region is released for the next one.
+      ScratchScope Scope;
+      ScratchVector<unsigned> Blocks;
+      RegionDataFlow DataFlow;
+
+      if (checkRegion(G, R, RegMetrics, Opts.Limits, Blocks, DataFlow) != RR_Valid)
+        continue;
+
+      RegionCosts Costs = getCostsOfRegion(G, R, Blocks, BBMetrics, RegMetrics);
+      std::string RegionName = G.getRegionName(R);
+      unsigned int Area = RegMetrics.get(R).Area;
+
+      Raw << G.Name << "\t" << RegionName << "\t" << Area << "\t";
+      Raw << static_cast<int64_t>(Costs.Freq) << "\t";
+      Raw << Costs.Speedup << "\t";
+      Raw << Costs.SWCost << "\t";
+      Raw << Costs.HWCost << " \t" << "\n";
+
+      RegionResultRow Row;
+      Row.Name     = Binary.intern(RegionName);
+      Row.Depth    = G.RegionDepth[R];
+      Row.Speedup  = Costs.Speedup;
+      Row.SWCost   = Costs.SWCost;
+      Row.HWCost   = Costs.HWCost;
+      Row.Overhead = Costs.Overhead;
+      Row.Area     = Area;
+      Row.Freq     = Costs.Freq;
+      Row.Inputs   = DataFlow.Inputs;
+      Row.Outputs  = DataFlow.Outputs;
+      Row.Loads    = DataFlow.Loads;
+      Row.Stores   = DataFlow.Stores;
+
+      // The closest enclosing Region that has results.
+      for (int32_t P = G.RegionParent[R]; P >= 0 && Row.Parent < 0; P = G.RegionParent[P])
+        Row.Parent = Rows[P];
+
+      Rows[R] = Binary.addRegion(Row);
+    }
+  }
+
+} // End of anonymous namespace
+
+int main(int argc, char **argv) {
+
+  Options Opts;
+
+  if (!parseOptions(argc, argv, Opts)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  CostModel Model;
+  std::string Error;
+
+  if (!Model.configure(Opts.Model, Error)) {
+    std::cerr << argv[0] << ": " << Error << "\n";
+    return 1;
+  }
+
+  if (Opts.PrintModel) {
+    Model.print(std::cout);
+    return std::cout ? 0 : 1;
+  }
+
+  std::ofstream File;
+  std::vector<char> Buffer(1 << 20);
+
+  if (!Opts.Output.empty()) {
+    File.rdbuf()->pubsetbuf(Buffer.data(), Buffer.size());
+    File.open(Opts.Output.c_str(), std::ofstream::out | std::ofstream::trunc);
+
+    if (!File.is_open()) {
+      std::cerr << argv[0] << ": cannot write '" << Opts.Output << "'\n";
+      return 1;
+    }
+  }
+
+  // Start from an empty results file, the Regions of every input are appended to it.
+  if (!Opts.Binary.empty() && !std::ofstream(Opts.Binary.c_str(), std::ofstream::out | std::ofstream::trunc)) {
+    std::cerr << argv[0] << ": cannot write '" << Opts.Binary << "'\n";
+    return 1;
+  }
+
+  std::ostream &Raw = Opts.Output.empty() ? std::cout : File;
+  RegionResultsWriter Binary;
+
+  // One snapshot file at a time, each becomes one chunk of the results file.
+  for (unsigned i = 0; i < Opts.Inputs.size(); i++) {
+
+    std::vector<RegionGraph> Graphs;
+
+    if (!readRegionGraphs(Opts.Inputs[i], Graphs, Error)) {
+      std::cerr << argv[0] << ": " << Error << "\n";
+      return 1;
+    }
+
+    for (unsigned j = 0; j < Graphs.size(); j++)
+      costFunction(Graphs[j], Opts, Model, Raw, Binary);
+
+    if (!Opts.Binary.empty() && !Binary.empty() && !Binary.append(Opts.Binary)) {
+      std::cerr << argv[0] << ": cannot write '" << Opts.Binary << "'\n";
+      return 1;
+    }
+
+    Binary.clear();
+  }
+
+  Raw.flush();
+
+  if (!Raw) {
+    std::cerr << argv[0] << ": cannot write '" << (Opts.Output.empty() ? "<stdout>" : Opts.Output) << "'\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,1506 @@
+//===---------------------------- RegionGraph.h -----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// RegionGraph is a snapshot of one Function as far as the Region costing is
+// concerned: its CFG, Region tree, Loop nest, Block Frequencies and, for each
+// Instruction, the Opcode and operand information the cost model needs. It is
+// a structure of arrays indexed by dense numbers and depends on the C++
+// standard library only, so the costing below runs the same inside the
+// IdentifyRegions pass and in offline tools (RegionCost) that load snapshots
+// saved with -rs-save-snapshots.
+//
+// A snapshot file is a sequence of chunks, one per Function, so that it can
+// be appended to. Each chunk is a RegionGraphHeader followed by the fields of
+// the RegionGraph in the order of RegionGraph::transfer, each array as its
+// length and its values, padded to 8 bytes. Values are in the byte order of
+// the machine that wrote them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef REGIONSEEKER_REGIONGRAPH_H
+#define REGIONSEEKER_REGIONGRAPH_H
+
+#include "CostModel.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#define REGION_GRAPH_MAGIC    "RSGRAPH"
+#define REGION_GRAPH_VERSION  1
+
+enum RegionGraphFlags : uint8_t {
+  RGF_TriviallyDead = 1       // The Instruction has no side effects and no uses.
+};
+
+struct RegionGraphHeader {
+
+  char     Magic[8];          // REGION_GRAPH_MAGIC, NUL terminated.
+  uint32_t Version;
+  uint32_t HeaderSize;        // sizeof(RegionGraphHeader)
+  uint64_t ChunkSize;         // Size of the chunk in bytes, header included.
+};
+
+// Snapshot of a Function. Instructions and Blocks are numbered in layout
+// order, Loops and Regions in pre-order of their trees.
+//
+// Operands refer to Values by number: Value V < getNumInsts() is Instruction
+// V, any other Value (Argument, Global, Constant, Block) is external Value
+// V - getNumInsts(). Integer constants are not Values of the graph at all,
+// their operands are -1.
+//
+struct RegionGraph {
+
+  std::string Name;                       // Function name.
+  int64_t EntryCount;                     // Function Entry Count from the "prof" metadata.
+
+  // Instructions.
+  std::vector<uint8_t>  Opcode;           // RGOpcode
+  std::vector<uint32_t> Aux;              // Operand dependent part of the cost, see CostModel.h.
+  std::vector<uint64_t> Bits;             // Size of the result in bits, 0 if unsized.
+  std::vector<uint8_t>  Flags;            // RegionGraphFlags
+  std::vector<uint32_t> OperandBegin;     // Operands of Instruction i are Operands[OperandBegin[i]] ... Operands[OperandBegin[i+1]-1].
+  std::vector<int32_t>  Operands;
+  std::vector<int32_t>  OperandBlocks;    // Incoming Block of each PHI operand, -1 for other operands.
+
+  // External Values.
+  std::vector<uint64_t> ExternalBits;     // Size in bits, 0 if unsized.
+
+  // Blocks. Block 0 is the entry of the Function.
+  std::vector<std::string> BlockNames;
+  std::vector<uint32_t> InstBegin;        // Instructions of Block b are InstBegin[b] ... InstBegin[b+1]-1, the last one is the terminator.
+  std::vector<uint32_t> SuccBegin;        // Successors, in the order of the terminator, duplicates kept.
+  std::vector<uint32_t> Succs;
+  std::vector<uint32_t> PredBegin;        // Predecessors, in the order LLVM lists them, duplicates kept.
+  std::vector<uint32_t> Preds;
+  std::vector<int32_t>  BlockLoop;        // Innermost Loop, -1 if none.
+  std::vector<int32_t>  BlockRegion;      // Innermost Region, -1 for unreachable Blocks.
+  std::vector<double>   FreqPerIter;      // Frequency relative to the entry of the Function.
+  std::vector<double>   FreqTotal;        // FreqPerIter times EntryCount.
+  std::vector<double>   FreqAnnotated;    // Frequency from the "freq" metadata, 0 if none.
+
+  // Loops.
+  std::vector<int32_t>  LoopParent;       // -1 for top level Loops.
+  std::vector<uint32_t> LoopHeader;
+  std::vector<uint32_t> LoopDepth;
+  std::vector<uint32_t> LoopTripCount;    // 0 if it is not a known small constant.
+
+  // Regions. Region 0 is the top level Region of the Function.
+  std::vector<int32_t>  RegionParent;     // -1 for Region 0.
+  std::vector<uint32_t> RegionEnd;        // The sub-Regions of r, at any depth, are r+1 ... RegionEnd[r]-1.
+  std::vector<uint32_t> RegionEntry;
+  std::vector<int32_t>  RegionExit;       // -1 for the top level Region.
+  std::vector<uint32_t> RegionDepth;
+
+  // Derived by buildUsers(), not saved.
+  std::vector<uint32_t> InstBlock;        // Block of each Instruction.
+  std::vector<uint32_t> UserBegin;        // Instructions using Instruction i are Users[UserBegin[i]] ... Users[UserBegin[i+1]-1].
+  std::vector<uint32_t> Users;
+
+  RegionGraph() : EntryCount(0) {}
+
+  unsigned getNumInsts()   const { return Opcode.size(); }
+  unsigned getNumBlocks()  const { return BlockNames.size(); }
+  unsigned getNumLoops()   const { return LoopParent.size(); }
+  unsigned getNumRegions() const { return RegionParent.size(); }
+
+  RGOpcode getOpcode(unsigned I) const { return static_cast<RGOpcode>(Opcode[I]); }
+
+  bool isInstruction(int32_t V) const { return V >= 0 && static_cast<uint32_t>(V) < getNumInsts(); }
+
+  uint64_t getValueBits(int32_t V) const { return isInstruction(V) ? Bits[V] : ExternalBits[V - getNumInsts()]; }
+
+  // Width of Instruction I for the cost model: the widest of its result and
+  // its operands. Integer constants do not count, they have no Value.
+  uint64_t getWidth(unsigned I) const {
+
+    uint64_t Width = Bits[I];
+
+    for (unsigned i = OperandBegin[I]; i < OperandBegin[I+1]; i++)
+      if (Operands[i] >= 0)
+        Width = std::max(Width, getValueBits(Operands[i]));
+
+    return Width;
+  }
+
+  unsigned getTerminator(unsigned B) const { return InstBegin[B+1] - 1; }
+
+  // @return  true if Block B is part of Region R or of one of its sub-Regions.
+  bool regionContains(unsigned R, unsigned B) const {
+
+    int32_t Inner = BlockRegion[B];
+    return Inner >= static_cast<int32_t>(R) && Inner < static_cast<int32_t>(RegionEnd[R]);
+  }
+
+  // @return  true if Block B is part of Loop L or of one of its sub-Loops.
+  bool loopContains(unsigned L, unsigned B) const {
+
+    for (int32_t Inner = BlockLoop[B]; Inner >= 0; Inner = LoopParent[Inner])
+      if (Inner == static_cast<int32_t>(L))
+        return true;
+
+    return false;
+  }
+
+  std::string getRegionName(unsigned R) const {
+
+    return BlockNames[RegionEntry[R]] + " => " + (RegionExit[R] < 0 ? std::string("<Function Return>") : BlockNames[RegionExit[R]]);
+  }
+
+  void clear() { *this = RegionGraph(); }
+
+  void buildUsers() {
+
+    InstBlock.assign(getNumInsts(), 0);
+    UserBegin.assign(getNumInsts() + 1, 0);
+    Users.assign(Operands.size(), 0);
+
+    for (unsigned B = 0; B < getNumBlocks(); B++)
+      for (unsigned I = InstBegin[B]; I < InstBegin[B+1]; I++)
+        InstBlock[I] = B;
+
+    for (unsigned i = 0; i < Operands.size(); i++)
+      if (isInstruction(Operands[i]))
+        UserBegin[Operands[i] + 1]++;
+
+    for (unsigned I = 0; I < getNumInsts(); I++)
+      UserBegin[I+1] += UserBegin[I];
+
+    std::vector<uint32_t> Next(UserBegin.begin(), UserBegin.end() - 1);
+
+    for (unsigned I = 0; I < getNumInsts(); I++)
+      for (unsigned i = OperandBegin[I]; i < OperandBegin[I+1]; i++)
+        if (isInstruction(Operands[i]))
+          Users[Next[Operands[i]]++] = I;
+
+    Users.resize(UserBegin.back());
+  }
+
+  // Visit the saved fields in file order with IO, a RegionGraphWriter,
+  // RegionGraphReader or RegionGraphHasher.
+  template <typename IO>
+  void transfer(IO &S) {
+
+    S.field(Name);
+    S.field(EntryCount);
+    S.field(Opcode);
+    S.field(Aux);
+    S.field(Bits);
+    S.field(Flags);
+    S.field(OperandBegin);
+    S.field(Operands);
+    S.field(OperandBlocks);
+    S.field(ExternalBits);
+    S.field(BlockNames);
+    S.field(InstBegin);
+    S.field(SuccBegin);
+    S.field(Succs);
+    S.field(PredBegin);
+    S.field(Preds);
+    S.field(BlockLoop);
+    S.field(BlockRegion);
+    S.field(FreqPerIter);
+    S.field(FreqTotal);
+    S.field(FreqAnnotated);
+    S.field(LoopParent);
+    S.field(LoopHeader);
+    S.field(LoopDepth);
+    S.field(LoopTripCount);
+    S.field(RegionParent);
+    S.field(RegionEnd);
+    S.field(RegionEntry);
+    S.field(RegionExit);
+    S.field(RegionDepth);
+  }
+
+  // Every number must refer to something that exists, so that a corrupt
+  // snapshot is rejected instead of costed.
+  bool isValid() const;
+};
+
+// Serializes a RegionGraph as one chunk.
+class RegionGraphWriter {
+
+  std::string &Out;
+
+  void pad() {
+
+    while (Out.size() % 8)
+      Out.push_back('\0');
+  }
+
+public:
+  RegionGraphWriter(std::string &Out) : Out(Out) {}
+
+  void field(int64_t Value) { Out.append(reinterpret_cast<const char *>(&Value), sizeof(Value)); }
+
+  void field(const std::string &S) {
+
+    field(static_cast<int64_t>(S.size()));
+    Out.append(S);
+    pad();
+  }
+
+  template <typename T>
+  void field(const std::vector<T> &V) {
+
+    field(static_cast<int64_t>(V.size()));
+    Out.append(reinterpret_cast<const char *>(V.data()), V.size() * sizeof(T));
+    pad();
+  }
+
+  void field(const std::vector<std::string> &V) {
+
+    field(static_cast<int64_t>(V.size()));
+    for (unsigned i = 0; i < V.size(); i++)
+      field(V[i]);
+  }
+
+  void write(const RegionGraph &G) {
+
+    RegionGraphHeader H;
+    std::memset(&H, 0, sizeof(H));
+    std::memcpy(H.Magic, REGION_GRAPH_MAGIC, sizeof(REGION_GRAPH_MAGIC));
+    H.Version = REGION_GRAPH_VERSION;
+    H.HeaderSize = sizeof(H);
+
+    size_t Start = Out.size();
+    Out.append(reinterpret_cast<const char *>(&H), sizeof(H));
+
+    const_cast<RegionGraph &>(G).transfer(*this);
+
+    uint64_t ChunkSize = Out.size() - Start;
+    std::memcpy(&Out[Start + offsetof(RegionGraphHeader, ChunkSize)], &ChunkSize, sizeof(ChunkSize));
+  }
+};
+
+// 64 bit FNV-1a hash of the fields of a RegionGraph, as they would be
+// serialized, and of any other field passed to it. Two Functions with the
+// same hash have the same snapshot and so the same costs.
+class RegionGraphHasher {
+
+  uint64_t Hash;
+
+  void add(const void *Data, uint64_t Size) {
+
+    const unsigned char *Bytes = static_cast<const unsigned char *>(Data);
+
+    for (uint64_t i = 0; i < Size; i++)
+      Hash = (Hash ^ Bytes[i]) * 1099511628211ULL;
+  }
+
+public:
+  RegionGraphHasher() : Hash(14695981039346656037ULL) {}
+
+  uint64_t getHash() const { return Hash; }
+
+  void field(int64_t Value) { add(&Value, sizeof(Value)); }
+
+  void field(const std::string &S) {
+
+    field(static_cast<int64_t>(S.size()));
+    add(S.data(), S.size());
+  }
+
+  template <typename T>
+  void field(const std::vector<T> &V) {
+
+    field(static_cast<int64_t>(V.size()));
+    add(V.data(), V.size() * sizeof(T));
+  }
+
+  void field(const std::vector<std::string> &V) {
+
+    field(static_cast<int64_t>(V.size()));
+    for (unsigned i = 0; i < V.size(); i++)
+      field(V[i]);
+  }
+
+  void field(const RegionGraph &G) { const_cast<RegionGraph &>(G).transfer(*this); }
+};
+
+// Deserializes a RegionGraph from one chunk, never reading past its end.
+class RegionGraphReader {
+
+  const char *Pos;
+  const char *End;
+  bool Failed;
+
+  bool take(void *To, uint64_t Size) {
+
+    if (Failed || Size > static_cast<uint64_t>(End - Pos)) {
+      Failed = true;
+      return false;
+    }
+
+    if (Size)
+      std::memcpy(To, Pos, Size);
+    Pos += Size;
+    return true;
+  }
+
+  void skipPadding(uint64_t Size) { Pos += std::min<uint64_t>((8 - Size % 8) % 8, End - Pos); }
+
+  // @return  The length of the next array, 0 if it does not fit in the chunk.
+  uint64_t length(uint64_t ElementSize) {
+
+    int64_t N = 0;
+
+    if (!take(&N, sizeof(N)) || N < 0 || static_cast<uint64_t>(N) > static_cast<uint64_t>(End - Pos) / ElementSize) {
+      Failed = true;
+      return 0;
+    }
+
+    return N;
+  }
+
+public:
+  RegionGraphReader(const char *Begin, const char *End) : Pos(Begin), End(End), Failed(false) {}
+
+  bool failed() const { return Failed; }
+
+  void field(int64_t &Value) { take(&Value, sizeof(Value)); }
+
+  void field(std::string &S) {
+
+    uint64_t N = length(1);
+    S.assign(Pos, N);
+    Pos += N;
+    skipPadding(N);
+  }
+
+  template <typename T>
+  void field(std::vector<T> &V) {
+
+    uint64_t N = length(sizeof(T));
+    V.resize(N);
+    take(V.data(), N * sizeof(T));
+    skipPadding(N * sizeof(T));
+  }
+
+  void field(std::vector<std::string> &V) {
+
+    // Every string takes at least its 8 byte length.
+    uint64_t N = length(8);
+    V.resize(N);
+    for (unsigned i = 0; i < N && !Failed; i++)
+      field(V[i]);
+  }
+};
+
+// Reads every chunk of a snapshot file.
+//
+// @return  false, with Error set, if the file cannot be read or is malformed.
+inline bool readRegionGraphs(const std::string &Path, std::vector<RegionGraph> &Graphs, std::string &Error) {
+
+  std::ifstream File(Path.c_str(), std::ifstream::in | std::ifstream::binary);
+
+  if (!File) {
+    Error = "cannot read '" + Path + "'";
+    return false;
+  }
+
+  std::vector<char> Data((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+
+  for (uint64_t Offset = 0; Offset < Data.size(); ) {
+
+    RegionGraphHeader H;
+
+    if (Data.size() - Offset < sizeof(H)) {
+      Error = "'" + Path + "' is truncated";
+      return false;
+    }
+
+    std::memcpy(&H, &Data[Offset], sizeof(H));
+
+    if (std::memcmp(H.Magic, REGION_GRAPH_MAGIC, sizeof(REGION_GRAPH_MAGIC))) {
+      Error = "'" + Path + "' is not a RegionGraph snapshot";
+      return false;
+    }
+
+    if (H.Version != REGION_GRAPH_VERSION) {
+      Error = "'" + Path + "' has unsupported version " + std::to_string(H.Version);
+      return false;
+    }
+
+    if (H.ChunkSize < H.HeaderSize || H.ChunkSize > Data.size() - Offset) {
+      Error = "'" + Path + "' is truncated";
+      return false;
+    }
+
+    Graphs.push_back(RegionGraph());
+    RegionGraph &G = Graphs.back();
+    RegionGraphReader Reader(&Data[Offset] + H.HeaderSize, &Data[Offset] + H.ChunkSize);
+    G.transfer(Reader);
+
+    if (Reader.failed() || !G.isValid()) {
+      Error = "'" + Path + "' has a malformed graph for Function '" + G.Name + "'";
+      return false;
+    }
+
+    G.buildUsers();
+    Offset += H.ChunkSize;
+  }
+
+  return true;
+}
+
+namespace {
+
+  // @return  true if Begin is a CSR index over Size elements whose values are all below Limit.
+  template <typename T>
+  bool isCSRValid(const std::vector<uint32_t> &Begin, unsigned Rows, const std::vector<T> &Values, int64_t Min, int64_t Limit) {
+
+    if (Begin.size() != Rows + 1 || Begin[0] != 0 || Begin.back() != Values.size())
+      return false;
+
+    for (unsigned i = 0; i < Rows; i++)
+      if (Begin[i] > Begin[i+1])
+        return false;
+
+    for (unsigned i = 0; i < Values.size(); i++)
+      if (static_cast<int64_t>(Values[i]) < Min || static_cast<int64_t>(Values[i]) >= Limit)
+        return false;
+
+    return true;
+  }
+
+  template <typename T>
+  bool isIndexValid(const std::vector<T> &Values, unsigned Size, int64_t Min, int64_t Limit) {
+
+    if (Values.size() != Size)
+      return false;
+
+    for (unsigned i = 0; i < Values.size(); i++)
+      if (static_cast<int64_t>(Values[i]) < Min || static_cast<int64_t>(Values[i]) >= Limit)
+        return false;
+
+    return true;
+  }
+
+} // End of anonymous namespace
+
+inline bool RegionGraph::isValid() const {
+
+  unsigned NI = getNumInsts(), NB = getNumBlocks(), NL = getNumLoops(), NR = getNumRegions();
+  int64_t NV = NI + ExternalBits.size();
+
+  if (Aux.size() != NI || Bits.size() != NI || Flags.size() != NI || OperandBlocks.size() != Operands.size() ||
+      FreqPerIter.size() != NB || FreqTotal.size() != NB || FreqAnnotated.size() != NB || NB == 0 || NR == 0)
+    return false;
+
+  for (unsigned I = 0; I < NI; I++)
+    if (Opcode[I] >= RG_NumOpcodes)
+      return false;
+
+  // Every Block has at least its terminator.
+  if (InstBegin.size() != NB + 1 || InstBegin[0] != 0 || InstBegin.back() != NI)
+    return false;
+
+  for (unsigned B = 0; B < NB; B++)
+    if (InstBegin[B] >= InstBegin[B+1])
+      return false;
+
+  if (!isCSRValid(OperandBegin, NI, Operands, -1, NV) ||
+      !isIndexValid(OperandBlocks, Operands.size(), -1, NB) ||
+      !isCSRValid(SuccBegin, NB, Succs, 0, NB) ||
+      !isCSRValid(PredBegin, NB, Preds, 0, NB) ||
+      !isIndexValid(BlockLoop, NB, -1, NL) ||
+      !isIndexValid(BlockRegion, NB, -1, NR) ||
+      !isIndexValid(LoopHeader, NL, 0, NB) ||
+      LoopDepth.size() != NL || LoopTripCount.size() != NL ||
+      !isIndexValid(RegionEntry, NR, 0, NB) ||
+      !isIndexValid(RegionExit, NR, -1, NB) ||
+      RegionDepth.size() != NR || RegionEnd.size() != NR)
+    return false;
+
+  // Parents come before their children.
+  for (unsigned L = 0; L < NL; L++)
+    if (LoopParent[L] >= static_cast<int32_t>(L))
+      return false;
+
+  for (unsigned R = 0; R < NR; R++)
+    if ((R == 0) != (RegionParent[R] < 0) || RegionParent[R] >= static_cast<int32_t>(R) ||
+        RegionEnd[R] <= R || RegionEnd[R] > NR ||
+        (R && RegionEnd[R] > RegionEnd[RegionParent[R]]))
+      return false;
+
+  return true;
+}
+
+namespace {
+
+  // Gather the Blocks of Region R in the order of LLVM's Region::block_iterator:
+  // a depth first pre-order walk of the CFG from the Entry that never goes
+  // through the Exit.
+  void getBlocksOfRegion(const RegionGraph &G, unsigned R, ScratchVector<unsigned> &Blocks) {
+
+    ScratchVector<char> Visited(G.getNumBlocks(), 0);
+    ScratchVector<std::pair<unsigned, unsigned> > Stack;
+
+    Blocks.clear();
+
+    if (G.RegionExit[R] >= 0)
+      Visited[G.RegionExit[R]] = 1;
+
+    unsigned Entry = G.RegionEntry[R];
+    Visited[Entry] = 1;
+    Blocks.push_back(Entry);
+    Stack.push_back(std::make_pair(Entry, G.SuccBegin[Entry]));
+
+    while (!Stack.empty()) {
+
+      unsigned Node = Stack.back().first;
+      unsigned &Next = Stack.back().second;
+
+      if (Next == G.SuccBegin[Node+1]) {
+        Stack.pop_back();
+        continue;
+      }
+
+      unsigned Succ = G.Succs[Next++];
+
+      if (!Visited[Succ]) {
+        Visited[Succ] = 1;
+        Blocks.push_back(Succ);
+        Stack.push_back(std::make_pair(Succ, G.SuccBegin[Succ]));
+      }
+    }
+  }
+
+  // The part of the DFG of Block B that does not depend on the cost model,
+  // so that its Critical Path can be computed under several models.
+  //
+  // An edge Send --> Receive is kept only when Send comes first in B, so the
+  // DFG is a DAG whose topological order is the program order itself.
+  // Operands of a PHI Node are considered only if they come from B.
+  struct BlockDFG {
+
+    ScratchVector<std::pair<unsigned, unsigned> > Edges; // Send_Node --> Receive_Node, sorted by Receive_Node.
+    ScratchVector<uint64_t> Widths;   // Of each Node, see RegionGraph::getWidth.
+    unsigned LoadsAndStores;
+
+    void build(const RegionGraph &G, unsigned B) {
+
+      unsigned First = G.InstBegin[B], NumNodes = G.InstBegin[B+1] - First;
+
+      Edges.clear();
+      Widths.resize(NumNodes);
+      LoadsAndStores = 0;
+
+      for (unsigned Receive = 0; Receive < NumNodes; Receive++) {
+
+        unsigned I = First + Receive;
+        bool IsPHI = G.getOpcode(I) == RG_PHI;
+
+        Widths[Receive] = G.getWidth(I);
+
+        if (G.getOpcode(I) == RG_Load || G.getOpcode(I) == RG_Store)
+          LoadsAndStores++;
+
+        for (unsigned i = G.OperandBegin[I]; i < G.OperandBegin[I+1]; i++) {
+
+          if (IsPHI && G.OperandBlocks[i] != static_cast<int32_t>(B))
+            continue;
+
+          int32_t Source = G.Operands[i];
+          if (!G.isInstruction(Source) || G.InstBlock[Source] != B)
+            continue;
+
+          unsigned Send = Source - First;
+          if (Send < Receive)
+            Edges.push_back(std::make_pair(Send, Receive));
+        }
+      }
+    }
+  };
+
+  // Critical Path of the DFG of Block B in nSecs under Model.
+  //
+  // @param  DFG  Of Block B.
+  float getDelayOfBlock(const RegionGraph &G, unsigned B, const BlockDFG &DFG, const CostModel &Model) {
+
+    ScratchScope Scope;
+    unsigned First = G.InstBegin[B], NumNodes = G.InstBegin[B+1] - First;
+    float DelayOfBB = 0;
+    ScratchVector<float> DelayNodes(NumNodes), DelayPaths;
+    const ScratchVector<std::pair<unsigned, unsigned> > &Edges = DFG.Edges;
+
+    for (unsigned Node = 0; Node < NumNodes; Node++) {
+
+      unsigned I = First + Node;
+      DelayNodes[Node] = Model.getDelayEstim(G.getOpcode(I), G.Aux[I], DFG.Widths[Node]);
+    }
+
+    if (Edges.size() > 0) {
+
+      // Every Receive_Node is final before it is used to relax its Send_Nodes.
+      DelayPaths = DelayNodes;
+
+      for (unsigned i = Edges.size(); i > 0; i--) {
+
+        unsigned Send    = Edges[i-1].first;
+        unsigned Receive = Edges[i-1].second;
+
+        DelayPaths[Send] = std::max(DelayPaths[Send], DelayNodes[Send] + DelayPaths[Receive]);
+      }
+
+      for (unsigned i = 0; i < NumNodes; i++)
+        if (DelayPaths[i] > DelayOfBB)
+          DelayOfBB = DelayPaths[i];
+    }
+
+    else
+      for (unsigned i = 0; i < NumNodes; i++)
+        DelayOfBB += DelayNodes[i];
+
+    // Compare Memory to Computation Delay, if the model makes BBs memory bound.
+    if (Model.LoadStoreDelay > 0) {
+
+      float LoadStoreDelay = DFG.LoadsAndStores * Model.LoadStoreDelay;
+      if (LoadStoreDelay > DelayOfBB)
+        DelayOfBB = LoadStoreDelay;
+    }
+
+    return DelayOfBB;
+  }
+
+  // Critical Path of the DFG of Block B in nSecs under Model.
+  float getDelayOfBlock(const RegionGraph &G, unsigned B, const CostModel &Model) {
+
+    ScratchScope Scope;
+    BlockDFG DFG;
+
+    DFG.build(G, B);
+    return getDelayOfBlock(G, B, DFG, Model);
+  }
+
+  // Dot product of A and B, N being a multiple of 8, on AVX vectors if the
+  // build enables them (e.g. -mavx2 or -march=native). Both versions add the
+  // products in the same order, so they give the same result.
+  float dotProduct(const float *A, const float *B, unsigned N) {
+
+    float Lanes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+  #ifdef __AVX__
+    __m256 Sum = _mm256_setzero_ps();
+
+    for (unsigned i = 0; i < N; i += 8)
+      Sum = _mm256_add_ps(Sum, _mm256_mul_ps(_mm256_loadu_ps(A + i), _mm256_loadu_ps(B + i)));
+
+    _mm256_storeu_ps(Lanes, Sum);
+  #else
+    for (unsigned i = 0; i < N; i += 8)
+      for (unsigned j = 0; j < 8; j++)
+        Lanes[j] += A[i+j] * B[i+j];
+  #endif
+
+    return ((Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3])) + ((Lanes[4] + Lanes[5]) + (Lanes[6] + Lanes[7]));
+  }
+
+  // Opcode histograms of the BBs of a RegionGraph: how many DFG Nodes of each
+  // bin of the cost tables (rgCostBin) a BB holds, and for a Switch how many
+  // Cases. The Area, SW Cost and unmarked Nodes of a BB under any CostModel
+  // are then dot products with its cost vectors, see BlockCostVectors.
+  //
+  // Only the bins that occur in the Function are kept, as Columns padded to a
+  // multiple of 8, so a row is a few vectors wide rather than RG_NumCostBins.
+  //
+  class BlockHistogramTable {
+
+    std::vector<unsigned> Bins;   // Bin of each Column, RG_NumCostBins for padding.
+    unsigned Columns;
+    std::vector<float> Counts;    // Counts[B * Columns + Column].
+
+  public:
+    BlockHistogramTable() : Columns(0) {}
+
+    void build(const RegionGraph &G) {
+
+      ScratchScope Scope;
+      ScratchVector<std::pair<unsigned, unsigned> > Entries; // Bin and count, for the BBs in order.
+      ScratchVector<unsigned> EntryBegin;
+      ScratchVector<int32_t> Column(RG_NumCostBins, -1);
+
+      for (unsigned B = 0; B < G.getNumBlocks(); B++) {
+
+        EntryBegin.push_back(Entries.size());
+
+        for (unsigned I = G.InstBegin[B]; I < G.InstBegin[B+1]; I++) {
+
+          RGOpcode Opcode = G.getOpcode(I);
+          unsigned W = rgWidthClass(G.getWidth(I));
+          RGAuxRule Rule = rgAuxRule(Opcode);
+
+          Entries.push_back(std::make_pair(rgCostBin(Opcode, Rule == RGA_Variant && G.Aux[I], W), 1u));
+
+          if (Rule == RGA_PerCase)
+            Entries.push_back(std::make_pair(rgCostBin(Opcode, 1, W), static_cast<unsigned>(G.Aux[I])));
+        }
+      }
+      EntryBegin.push_back(Entries.size());
+
+      Bins.clear();
+
+      for (unsigned i = 0; i < Entries.size(); i++)
+        if (Column[Entries[i].first] < 0) {
+          Column[Entries[i].first] = Bins.size();
+          Bins.push_back(Entries[i].first);
+        }
+
+      Columns = (Bins.size() + 7) / 8 * 8;
+      Bins.resize(Columns, RG_NumCostBins);
+      Counts.assign(G.getNumBlocks() * Columns, 0);
+
+      for (unsigned B = 0; B < G.getNumBlocks(); B++)
+        for (unsigned i = EntryBegin[B]; i < EntryBegin[B+1]; i++)
+          Counts[B * Columns + Column[Entries[i].first]] += Entries[i].second;
+    }
+
+    unsigned getColumns() const { return Columns; }
+
+    const float *get(unsigned B) const { return Counts.data() + B * Columns; }
+
+    // Vector, indexed by bin, as the Columns.
+    void gather(const std::vector<float> &Vector, std::vector<float> &Out) const {
+
+      Out.resize(Columns);
+
+      for (unsigned c = 0; c < Columns; c++)
+        Out[c] = Bins[c] < RG_NumCostBins ? Vector[Bins[c]] : 0;
+    }
+  };
+
+  // The cost vectors of a CostModel (CostModel::getCostVectors) as the
+  // Columns of a BlockHistogramTable.
+  struct BlockCostVectors {
+
+    std::vector<float> Area;
+    std::vector<float> SWCycles;
+    std::vector<float> Good;
+
+    void reset(const CostModel &Model, const BlockHistogramTable &Histograms) {
+
+      std::vector<float> AreaBins, SWCyclesBins, GoodBins;
+
+      Model.getCostVectors(AreaBins, SWCyclesBins, GoodBins);
+      Histograms.gather(AreaBins, Area);
+      Histograms.gather(SWCyclesBins, SWCycles);
+      Histograms.gather(GoodBins, Good);
+    }
+  };
+
+  // Metrics of a BB that do not depend on the Region it is part of.
+  struct BlockMetrics {
+
+    float Delay;                // Critical Path of the DFG in nSecs.
+    long int SWCost;            // Software Cost in Cycles, for one execution.
+    unsigned int Area;          // Area in LUTs.
+    unsigned int DFGNodes;
+    unsigned int GoodDFGNodes;  // DFG Nodes that are not marked.
+    unsigned int Loads;
+    unsigned int Stores;
+    uint64_t LoadBits;          // Total bitwidth of the Loads.
+    uint64_t StoreBits;         // Total bitwidth of the Stores.
+    bool CallFree;
+  };
+
+  // The Area, SW Cost and unmarked Nodes of B are dot products of its
+  // histogram with the cost vectors of Model, only its Delay is computed
+  // Node by Node.
+  BlockMetrics computeBlockMetrics(const RegionGraph &G, unsigned B, const CostModel &Model,
+                                   const BlockHistogramTable &Histograms, const BlockCostVectors &Vectors) {
+
+    BlockMetrics M;
+    const float *Histogram = Histograms.get(B);
+    unsigned Columns = Histograms.getColumns();
+
+    M.Delay = getDelayOfBlock(G, B, Model);
+    M.SWCost = static_cast<long int>(dotProduct(Histogram, Vectors.SWCycles.data(), Columns));
+    M.Area = static_cast<unsigned int>(dotProduct(Histogram, Vectors.Area.data(), Columns));
+    M.DFGNodes = G.InstBegin[B+1] - G.InstBegin[B];
+    M.GoodDFGNodes = static_cast<unsigned int>(dotProduct(Histogram, Vectors.Good.data(), Columns));
+    M.Loads = 0;
+    M.Stores = 0;
+    M.LoadBits = 0;
+    M.StoreBits = 0;
+    M.CallFree = true;
+
+    for (unsigned I = G.InstBegin[B]; I < G.InstBegin[B+1]; I++) {
+
+      RGOpcode Opcode = G.getOpcode(I);
+
+      if (Opcode == RG_Call)
+        M.CallFree = false;
+
+      if (Opcode == RG_Load) {
+        M.LoadBits += G.Aux[I];
+        M.Loads++;
+      }
+
+      if (Opcode == RG_Store) {
+        M.StoreBits += G.Aux[I];
+        M.Stores++;
+      }
+    }
+
+    return M;
+  }
+
+  // BlockMetrics of the BBs of a RegionGraph. A BB is measured the first time
+  // any Region asks for it, so BBs shared by nested Regions are measured once.
+  // The opcode histograms of all the BBs are built up front.
+  //
+  class BlockMetricsTable {
+
+    const RegionGraph *G;
+    const CostModel *Model;
+    BlockHistogramTable Histograms;
+    BlockCostVectors Vectors;
+    std::vector<BlockMetrics> Metrics;
+    std::vector<bool> Computed;
+
+  public:
+    BlockMetricsTable() : G(nullptr), Model(nullptr) {}
+
+    void reset(const RegionGraph &Graph, const CostModel &CM) {
+
+      G = &Graph;
+      Model = &CM;
+      Histograms.build(Graph);
+      Vectors.reset(CM, Histograms);
+      Metrics.assign(Graph.getNumBlocks(), BlockMetrics());
+      Computed.assign(Graph.getNumBlocks(), false);
+    }
+
+    const BlockMetrics &get(unsigned B) {
+
+      if (!Computed[B]) {
+        Metrics[B] = computeBlockMetrics(*G, B, *Model, Histograms, Vectors);
+        Computed[B] = true;
+      }
+
+      return Metrics[B];
+    }
+
+    const CostModel &getModel() const { return *Model; }
+
+    const BlockHistogramTable &getHistograms() const { return Histograms; }
+  };
+
+  // The costs of the BBs of a RegionGraph that depend on the cost model, for
+  // several configurations (cost models, with their clock period and
+  // invocation overhead) at once. The values of a BB are contiguous, one per
+  // configuration, so that the Regions are costed for all of them in a
+  // single walk over their CFG, see getConfigCostsOfRegion. The DFG of a BB
+  // and its histogram are built once for all the configurations.
+  //
+  class ConfigMetricsTable {
+
+    const RegionGraph *G;
+    const std::vector<CostModel> *Models;
+    const BlockHistogramTable *Histograms;
+    std::vector<BlockCostVectors> Vectors;
+    std::vector<long int> HWCost;   // HW Cost in Cycles, weighted by the BB Frequency.
+    std::vector<int64_t> SWCost;    // SW Cost in Cycles, weighted by the BB Frequency.
+    std::vector<bool> Computed;
+
+  public:
+    ConfigMetricsTable() : G(nullptr), Models(nullptr), Histograms(nullptr) {}
+
+    // @param  Hists  The opcode histograms of Graph, see BlockMetricsTable::getHistograms.
+    void reset(const RegionGraph &Graph, const std::vector<CostModel> &CMs, const BlockHistogramTable &Hists) {
+
+      G = &Graph;
+      Models = &CMs;
+      Histograms = &Hists;
+      Vectors.resize(CMs.size());
+      for (unsigned C = 0; C < CMs.size(); C++)
+        Vectors[C].reset(CMs[C], Hists);
+      HWCost.assign(Graph.getNumBlocks() * CMs.size(), 0);
+      SWCost.assign(Graph.getNumBlocks() * CMs.size(), 0);
+      Computed.assign(Graph.getNumBlocks(), false);
+    }
+
+    unsigned size() const { return Models ? Models->size() : 0; }
+
+    const CostModel &getModel(unsigned C) const { return (*Models)[C]; }
+
+    // The HW and SW Costs of BB B, size() of each, computed as
+    // getHWCostOfRegion and RegionMetrics do for one model.
+    const long int *getHWCost(unsigned B) { compute(B); return &HWCost[B * size()]; }
+    const int64_t *getSWCost(unsigned B) { compute(B); return &SWCost[B * size()]; }
+
+  private:
+    void compute(unsigned B) {
+
+      if (Computed[B])
+        return;
+
+      ScratchScope Scope;
+      BlockDFG DFG;
+      const float *Histogram = Histograms->get(B);
+
+      DFG.build(*G, B);
+
+      for (unsigned C = 0; C < size(); C++) {
+
+        float Delay = getDelayOfBlock(*G, B, DFG, getModel(C));
+        long int SWCycles = static_cast<long int>(dotProduct(Histogram, Vectors[C].SWCycles.data(), Histograms->getColumns()));
+
+        HWCost[B * size() + C] = ceil( Delay / static_cast<float>(getModel(C).NsecsPerCycle) ) * G->FreqTotal[B];
+        SWCost[B * size() + C] = static_cast<int64_t>(SWCycles * G->FreqTotal[B]);
+      }
+
+      Computed[B] = true;
+    }
+  };
+
+  // Metrics of a Region. All of them are sums over its BBs, except CallFree
+  // which holds only if it holds for every BB.
+  struct RegionMetrics {
+
+    unsigned int BBs;
+    unsigned int DFGNodes;
+    unsigned int GoodDFGNodes;
+    unsigned int Goodness;      // Optimality of the Region.
+    unsigned int Area;          // Area in LUTs.
+    int64_t SWCost;             // Software Cost in Cycles, weighted by the BB Frequencies.
+    unsigned int Loads;
+    unsigned int Stores;
+    uint64_t LoadBits;
+    uint64_t StoreBits;
+    bool CallFree;
+
+    RegionMetrics() : BBs(0), DFGNodes(0), GoodDFGNodes(0), Goodness(0), Area(0), SWCost(0),
+                      Loads(0), Stores(0), LoadBits(0), StoreBits(0), CallFree(true) {}
+
+    // @param  Freq           Total Frequency of the BB.
+    // @param  AnnotatedFreq  Annotated Frequency of the BB, weighting its Goodness.
+    void addBlock(const BlockMetrics &M, double Freq, double AnnotatedFreq) {
+
+      BBs++;
+      DFGNodes     += M.DFGNodes;
+      GoodDFGNodes += M.GoodDFGNodes;
+      Goodness     += static_cast<unsigned int>(M.GoodDFGNodes * AnnotatedFreq);
+      Area         += M.Area;
+      SWCost       += static_cast<int64_t>(M.SWCost * Freq);
+      Loads        += M.Loads;
+      Stores       += M.Stores;
+      LoadBits     += M.LoadBits;
+      StoreBits    += M.StoreBits;
+      CallFree     &= M.CallFree;
+    }
+
+    void addRegion(const RegionMetrics &Sub) {
+
+      BBs          += Sub.BBs;
+      DFGNodes     += Sub.DFGNodes;
+      GoodDFGNodes += Sub.GoodDFGNodes;
+      Goodness     += Sub.Goodness;
+      Area         += Sub.Area;
+      SWCost       += Sub.SWCost;
+      Loads        += Sub.Loads;
+      Stores       += Sub.Stores;
+      LoadBits     += Sub.LoadBits;
+      StoreBits    += Sub.StoreBits;
+      CallFree     &= Sub.CallFree;
+    }
+
+    // Density of the Region. Every BB has at least its terminator, so DFGNodes is never 0.
+    unsigned int getDensity() const { return Goodness / DFGNodes; }
+  };
+
+  // RegionMetrics of every Region of a RegionGraph.
+  //
+  // Each BB is added to the innermost Region that contains it, then the tree
+  // is folded bottom-up so that every Region is its own BBs plus its
+  // children. The whole tree costs one walk over the BBs of the Function.
+  //
+  class RegionMetricsTree {
+
+    std::vector<RegionMetrics> Metrics;
+
+  public:
+    void build(const RegionGraph &G, BlockMetricsTable &BBMetrics) {
+
+      Metrics.assign(G.getNumRegions(), RegionMetrics());
+
+      for (unsigned B = 0; B < G.getNumBlocks(); B++)
+        if (G.BlockRegion[B] >= 0)
+          Metrics[G.BlockRegion[B]].addBlock(BBMetrics.get(B), G.FreqTotal[B], G.FreqAnnotated[B]);
+
+      // Children come after their parent in pre-order, so a reverse walk
+      // finishes every child before it is added to its parent.
+      for (unsigned R = G.getNumRegions(); R-- > 1; )
+        Metrics[G.RegionParent[R]].addRegion(Metrics[R]);
+    }
+
+    const RegionMetrics &get(unsigned R) const { return Metrics[R]; }
+  };
+
+  // Control Flow Graph of a Region.
+  //
+  // Blocks are numbered densely in the order of getBlocksOfRegion, so the
+  // Entry of the Region is Block 0. Edges that leave the Region, self loops
+  // and back edges (edges to the header of a Loop that contains the source)
+  // are dropped. What is left is a DAG and TopoOrder lists its blocks in a
+  // topological order.
+  //
+  struct RegionCFG {
+
+    ScratchVector<unsigned> Blocks;     // Number of each Block in the RegionGraph.
+    ScratchVector<unsigned> SuccBegin;  // Successors of Block i are Succs[SuccBegin[i]] ... Succs[SuccBegin[i+1]-1].
+    ScratchVector<unsigned> Succs;
+    ScratchVector<unsigned> TopoOrder;
+
+    RegionCFG(const RegionGraph &G, const ScratchVector<unsigned> &RegionBlocks) : Blocks(RegionBlocks) {
+
+      ScratchVector<int32_t> Index(G.getNumBlocks(), -1);
+
+      for (unsigned i = 0; i < Blocks.size(); i++)
+        Index[Blocks[i]] = i;
+
+      // Predecessor --> Successor
+      for (unsigned i = 0; i < Blocks.size(); i++) {
+
+        SuccBegin.push_back(Succs.size());
+
+        for (unsigned j = G.SuccBegin[Blocks[i]]; j < G.SuccBegin[Blocks[i]+1]; j++) {
+
+          unsigned Succ = G.Succs[j];
+
+          if (Index[Succ] < 0 || Index[Succ] == static_cast<int32_t>(i) || isBackEdge(G, Blocks[i], Succ))
+            continue;
+
+          Succs.push_back(Index[Succ]);
+        }
+      }
+      SuccBegin.push_back(Succs.size());
+
+      sortTopologically();
+    }
+
+    static bool isBackEdge(const RegionGraph &G, unsigned From, unsigned To) {
+
+      int32_t L = G.BlockLoop[To];
+      return L >= 0 && G.LoopHeader[L] == To && G.loopContains(L, From);
+    }
+
+    // Reverse post-order of a DFS from the Entry. Edges that still close a
+    // cycle (irreducible control flow, unknown to LoopInfo) are dropped too.
+    void sortTopologically() {
+
+      ScratchVector<unsigned> PostOrder, Position(Blocks.size());
+      ScratchVector<char> State(Blocks.size(), 0); // 0: new, 1: on the DFS stack, 2: done.
+      ScratchVector<std::pair<unsigned, unsigned> > Stack;
+
+      for (unsigned Root = 0; Root < Blocks.size(); Root++) {
+
+        if (State[Root])
+          continue;
+
+        State[Root] = 1;
+        Stack.push_back(std::make_pair(Root, SuccBegin[Root]));
+
+        while (!Stack.empty()) {
+
+          unsigned Node = Stack.back().first;
+          unsigned &Next = Stack.back().second;
+
+          if (Next == SuccBegin[Node+1]) {
+            State[Node] = 2;
+            PostOrder.push_back(Node);
+            Stack.pop_back();
+            continue;
+          }
+
+          unsigned Succ = Succs[Next++];
+
+          if (!State[Succ]) {
+            State[Succ] = 1;
+            Stack.push_back(std::make_pair(Succ, SuccBegin[Succ]));
+          }
+        }
+      }
+
+      TopoOrder.assign(PostOrder.rbegin(), PostOrder.rend());
+
+      for (unsigned i = 0; i < TopoOrder.size(); i++)
+        Position[TopoOrder[i]] = i;
+
+      // Keep only the edges that go forward in the topological order.
+      unsigned Kept = 0;
+
+      for (unsigned i = 0; i < Blocks.size(); i++) {
+
+        unsigned Begin = SuccBegin[i];
+        SuccBegin[i] = Kept;
+
+        for (unsigned j = Begin; j < SuccBegin[i+1]; j++)
+          if (Position[Succs[j]] > Position[i])
+            Succs[Kept++] = Succs[j];
+      }
+
+      SuccBegin[Blocks.size()] = Kept;
+      Succs.resize(Kept);
+    }
+  };
+
+  // Most expensive path of a Region's CFG given the Cost of each Block.
+  //
+  // Blocks are visited in reverse topological order, so on return CostPath[i]
+  // holds the Cost of the most expensive path starting from Block i.
+  //
+  // @return  The Cost of the Critical Path of the Region.
+  template <typename T>
+  T getCriticalPathOfRegion(const RegionCFG &CFG, const ScratchVector<T> &CostBB, ScratchVector<T> &CostPath) {
+
+    T CriticalPath = 0;
+    CostPath = CostBB;
+
+    for (unsigned i = CFG.TopoOrder.size(); i > 0; i--) {
+
+      unsigned Node = CFG.TopoOrder[i-1];
+      T MaxSucc = 0;
+
+      for (unsigned j = CFG.SuccBegin[Node]; j < CFG.SuccBegin[Node+1]; j++)
+        MaxSucc = std::max(MaxSucc, CostPath[CFG.Succs[j]]);
+
+      CostPath[Node] = CostBB[Node] + MaxSucc;
+      CriticalPath = std::max(CriticalPath, CostPath[Node]);
+    }
+
+    return CriticalPath;
+  }
+
+  // getCriticalPathOfRegion for N Costs per Block at once, CostBB[i*N+c] being
+  // the Cost of Block i in the c-th of them. The inner loops run over the N
+  // Costs of a Block, with no dependency between them, so they vectorize.
+  //
+  // On return CriticalPath holds the N Costs of the Critical Path.
+  template <typename T>
+  void getCriticalPathsOfRegion(const RegionCFG &CFG, unsigned N, const ScratchVector<T> &CostBB,
+                                ScratchVector<T> &CostPath, ScratchVector<T> &CriticalPath) {
+
+    CostPath = CostBB;
+    CriticalPath.assign(N, 0);
+    ScratchVector<T> MaxSucc(N);
+
+    for (unsigned i = CFG.TopoOrder.size(); i > 0; i--) {
+
+      unsigned Node = CFG.TopoOrder[i-1];
+      T *Path = &CostPath[Node * N];
+
+      std::fill(MaxSucc.begin(), MaxSucc.end(), 0);
+
+      for (unsigned j = CFG.SuccBegin[Node]; j < CFG.SuccBegin[Node+1]; j++) {
+
+        const T *SuccPath = &CostPath[CFG.Succs[j] * N];
+
+        for (unsigned c = 0; c < N; c++)
+          MaxSucc[c] = std::max(MaxSucc[c], SuccPath[c]);
+      }
+
+      for (unsigned c = 0; c < N; c++) {
+        Path[c] += MaxSucc[c];
+        CriticalPath[c] = std::max(CriticalPath[c], Path[c]);
+      }
+    }
+  }
+
+  // Get the Hardware Cost (Cycles) of the Region.
+  //
+  // The Cost of a BB is its Critical Path in Cycles multiplied by its total
+  // Frequency. The Cost of the Region is the most expensive path of its CFG
+  // once back edges are removed.
+  long int getHWCostOfRegion(const RegionGraph &G, const RegionCFG &CFG, BlockMetricsTable &BBMetrics) {
+
+    ScratchScope Scope;
+    ScratchVector<long int> HWCostBB, HWCostPath;
+
+    for (unsigned i = 0; i < CFG.Blocks.size(); i++) {
+
+      float DelayBB = BBMetrics.get(CFG.Blocks[i]).Delay;
+      HWCostBB.push_back(ceil( DelayBB / static_cast<float>(BBMetrics.getModel().NsecsPerCycle) ) * G.FreqTotal[CFG.Blocks[i]] ); // HW Cost for each BB (Cyclified)
+    }
+
+    return getCriticalPathOfRegion(CFG, HWCostBB, HWCostPath); // Total Cycles spent on HW.
+  }
+
+
+  // Total Frequency the Region is entered with.
+  //
+  // It is the Frequency of its Entry, unless the Entry is also reached from
+  // inside the Region (a Loop), in which case it is the sum of the
+  // Frequencies of the unconditional branches from outside of the Region.
+  double getRegionTotalFreq(const RegionGraph &G, unsigned R) {
+
+    double RegionFreq = 0;
+    bool backedge = false;
+    unsigned BB_entry = G.RegionEntry[R];
+    double BBEntryFreq = G.FreqTotal[BB_entry]; // Freq_Total
+
+    // Case Entry of Region is Entry of Function.
+    if (BB_entry == 0)
+      return static_cast<double>(G.EntryCount);
+
+    // Single Predecessor.
+    if (G.PredBegin[BB_entry+1] - G.PredBegin[BB_entry] == 1)
+      return BBEntryFreq;
+
+    for (unsigned i = G.PredBegin[BB_entry]; i < G.PredBegin[BB_entry+1]; i++) {
+
+      unsigned BB_pred = G.Preds[i];
+
+      if (G.regionContains(R, BB_pred)) {
+        backedge = true;
+        continue;
+      }
+
+      // Unconditional Branch.
+      unsigned Terminator = G.getTerminator(BB_pred);
+      if (G.getOpcode(Terminator) == RG_Br && G.SuccBegin[BB_pred+1] - G.SuccBegin[BB_pred] == 1)
+        RegionFreq += G.FreqTotal[BB_pred]; // Freq_Total
+    }
+
+    if (!backedge)
+      return BBEntryFreq;
+
+    return RegionFreq;
+  }
+
+  // Costs of a Region, as written to the Region files.
+  struct RegionCosts {
+
+    double Freq;          // Total Frequency the Region is entered with.
+    long int SWCost;      // Software Cost in Cycles.
+    long int HWCost;      // Hardware Cost in Cycles.
+    long int Overhead;    // Cost of invoking the accelerator, in Cycles.
+    long int Speedup;     // Cycles saved: SWCost - HWCost - Overhead.
+  };
+
+  // Costs of a Region under every configuration of a ConfigMetricsTable, as
+  // in RegionCosts.
+  struct RegionConfigCosts {
+
+    ScratchVector<long int> SWCost;
+    ScratchVector<long int> HWCost;
+    ScratchVector<long int> Overhead;
+    ScratchVector<long int> Speedup;
+  };
+
+  // @param  Blocks  The Blocks of Region R, from getBlocksOfRegion.
+  RegionCosts getCostsOfRegion(const RegionGraph &G, unsigned R, const ScratchVector<unsigned> &Blocks,
+                               BlockMetricsTable &BBMetrics, const RegionMetricsTree &RegMetrics) {
+
+    RegionCosts Costs;
+    RegionCFG CFG(G, Blocks);
+
+    Costs.Freq     = getRegionTotalFreq(G, R);
+    Costs.SWCost   = static_cast<long int> (RegMetrics.get(R).SWCost);
+    Costs.HWCost   = static_cast<long int> (getHWCostOfRegion(G, CFG, BBMetrics));
+    Costs.Overhead = static_cast<long int> (Costs.Freq * BBMetrics.getModel().CallOverhead);
+
+    // Final "Speedup" of a Region.
+    Costs.Speedup  = Costs.SWCost - Costs.HWCost - Costs.Overhead;
+
+    return Costs;
+  }
+
+  // Data Flow boundary of a Region.
+  struct RegionDataFlow {
+
+    unsigned int Inputs;    // # of distinct Values flowing into the Region.
+    unsigned int Outputs;   // # of Instructions of the Region used outside of it.
+    uint64_t InputBits;     // Total bitwidth of the Inputs.
+    uint64_t OutputBits;    // Total bitwidth of the Outputs.
+    unsigned int Loads;
+    unsigned int Stores;
+    uint64_t LoadBits;      // Total bitwidth of the Loads.
+    uint64_t StoreBits;     // Total bitwidth of the Stores.
+
+    RegionDataFlow() : Inputs(0), Outputs(0), InputBits(0), OutputBits(0), Loads(0), Stores(0), LoadBits(0), StoreBits(0) {}
+  };
+
+  // @brief  Gather the Data Flow boundary of the region in one pass.
+  //
+  // An operand is an Input if it is not produced by an Instruction of the
+  // Region, and an Instruction is an Output if it has a User outside of the
+  // Region. Branches are not considered, and trivially dead Instructions
+  // only for their Loads and Stores.
+  //
+  // The pass stops as soon as the Region is known to have more Inputs than
+  // MaxInputs or more Outputs than MaxOutputs. The Data Flow is then only
+  // partial, with Inputs or Outputs over its limit.
+  //
+  // @param  Blocks  The Blocks of Region R, from getBlocksOfRegion.
+  RegionDataFlow getDataFlowOfRegion(const RegionGraph &G, unsigned R, const ScratchVector<unsigned> &Blocks,
+                                     unsigned MaxInputs = ~0U, unsigned MaxOutputs = ~0U) {
+
+    ScratchScope Scope;
+    RegionDataFlow DataFlow;
+    ScratchVector<int32_t> ext_in;
+
+    // ext_in holds duplicates, it is made unique to count the Inputs once it
+    // grows past Compact, then again after MaxInputs more operands.
+    size_t Compact = MaxInputs;
+
+    for (unsigned b = 0; b < Blocks.size(); b++) {
+
+      for (unsigned I = G.InstBegin[Blocks[b]]; I < G.InstBegin[Blocks[b]+1]; I++) {
+
+        RGOpcode Opcode = G.getOpcode(I);
+
+        // Do not consider Branch Instructions.
+        if (Opcode == RG_Br)
+          continue;
+
+        if (Opcode == RG_Load) {
+          DataFlow.LoadBits += G.Aux[I];
+          ++DataFlow.Loads;
+        }
+
+        if (Opcode == RG_Store) {
+          DataFlow.StoreBits += G.Aux[I];
+          ++DataFlow.Stores;
+        }
+
+        if (G.Flags[I] & RGF_TriviallyDead)
+          continue;
+
+        // Input: operands not coming from an Instruction of the Region. Integer constants are excluded.
+        for (unsigned i = G.OperandBegin[I]; i < G.OperandBegin[I+1]; i++) {
+
+          int32_t Operand = G.Operands[i];
+
+          if (Operand < 0 || (G.isInstruction(Operand) && G.regionContains(R, G.InstBlock[Operand])))
+            continue;
+
+          ext_in.push_back(Operand);
+        }
+
+        if (ext_in.size() > Compact) {
+
+          std::sort(ext_in.begin(), ext_in.end());
+          ext_in.erase(std::unique(ext_in.begin(), ext_in.end()), ext_in.end());
+
+          if (ext_in.size() > MaxInputs) {
+            DataFlow.Inputs = ext_in.size();
+            return DataFlow;
+          }
+
+          Compact = ext_in.size() + MaxInputs;
+        }
+
+        // Output: If a User is not inside this Region then the Instruction is considered as output.
+        for (unsigned i = G.UserBegin[I]; i < G.UserBegin[I+1]; i++) {
+
+          if (!G.regionContains(R, G.InstBlock[G.Users[i]])) {
+            ++DataFlow.Outputs;
+            DataFlow.OutputBits += G.Bits[I];
+            break;
+          }
+        }
+
+        if (DataFlow.Outputs > MaxOutputs)
+          return DataFlow;
+      }
+    }
+
+    std::sort(ext_in.begin(), ext_in.end());
+    ext_in.erase(std::unique(ext_in.begin(), ext_in.end()), ext_in.end());
+
+    DataFlow.Inputs = ext_in.size();
+    for (unsigned i = 0; i < ext_in.size(); i++)
+      DataFlow.InputBits += G.getValueBits(ext_in[i]);
+
+    return DataFlow;
+  }
+
+  // Limits on the Regions that are candidates for acceleration, none by default.
+  struct RegionLimits {
+
+    unsigned int MaxBlocks;
+    unsigned int MaxNodes;    // DFG Nodes.
+    double MinFreq;           // Frequency the Region is entered with, see getRegionTotalFreq.
+    unsigned int MaxInputs;
+    unsigned int MaxOutputs;
+
+    RegionLimits() : MaxBlocks(~0U), MaxNodes(~0U), MinFreq(0), MaxInputs(~0U), MaxOutputs(~0U) {}
+  };
+
+  // Why checkRegion rejects a Region, in the order of its checks.
+  enum RegionRejection {
+    RR_Valid,
+    RR_NoExit,        // The Region is the whole Function.
+    RR_Call,          // It contains a call.
+    RR_Blocks,        // It has more BBs than RegionLimits::MaxBlocks,
+    RR_Nodes,         // or more DFG Nodes than RegionLimits::MaxNodes.
+    RR_Freq,          // It is entered less often than RegionLimits::MinFreq.
+    RR_Inputs,        // It has more Inputs than RegionLimits::MaxInputs,
+    RR_Outputs,       // or more Outputs than RegionLimits::MaxOutputs.
+    RR_NumRejections
+  };
+
+  // @brief  Check whether Region R is a candidate for acceleration.
+  //
+  // The checks run from the cheapest to the most expensive and the first
+  // that fails rejects R: its Exit, calls, size and Frequency, from what is
+  // already known of R, then its Data Flow, which walks its Blocks.
+  //
+  // @param  Blocks    Set to the Blocks of R, from getBlocksOfRegion, if the Data Flow is checked.
+  // @param  DataFlow  Set to the Data Flow of R if it is valid.
+  RegionRejection checkRegion(const RegionGraph &G, unsigned R, const RegionMetricsTree &RegMetrics,
+                              const RegionLimits &Limits, ScratchVector<unsigned> &Blocks,
+                              RegionDataFlow &DataFlow) {
+
+    const RegionMetrics &Metrics = RegMetrics.get(R);
+
+    if (G.RegionExit[R] < 0)
+      return RR_NoExit;
+
+    if (!Metrics.CallFree)
+      return RR_Call;
+
+    if (Metrics.BBs > Limits.MaxBlocks)
+      return RR_Blocks;
+
+    if (Metrics.DFGNodes > Limits.MaxNodes)
+      return RR_Nodes;
+
+    if (Limits.MinFreq > 0 && getRegionTotalFreq(G, R) < Limits.MinFreq)
+      return RR_Freq;
+
+    getBlocksOfRegion(G, R, Blocks);
+    DataFlow = getDataFlowOfRegion(G, R, Blocks, Limits.MaxInputs, Limits.MaxOutputs);
+
+    if (DataFlow.Inputs > Limits.MaxInputs)
+      return RR_Inputs;
+
+    if (DataFlow.Outputs > Limits.MaxOutputs)
+      return RR_Outputs;
+
+    return RR_Valid;
+  }
+
+} // End of anonymous namespace
+
+#endif // REGIONSEEKER_REGIONGRAPH_H
@@ -0,0 +1,517 @@
+//===--------------------------- RegionResults.h ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Binary, columnar format of the Region results, written next to the text
+// outputs (Regions.txt, Regions_raw.txt) by the IdentifyRegions pass, and a
+// reader that memory maps it. Depends on the C++ standard library only, so
+// that selection tools can load results without linking LLVM.
+//
+// A results file is a sequence of chunks, one per analyzed Module, so that it
+// can be appended to the same way as the text outputs. Each chunk is
+//
+//   RegionResultsHeader
+//   RegionResultsFunction   x NumFunctions   Function index.
+//   RegionResultsColumn     x NumColumns     Column directory (schema).
+//   Column data, each column 8 byte aligned, NumRegions values.
+//   String table            NUL terminated, interned Function/Region names.
+//
+// All offsets are relative to the start of the chunk, values are in the byte
+// order of the machine that wrote them. Regions of a Function are contiguous
+// and in pre-order of the Region tree, so a Parent comes before its children.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef REGIONSEEKER_REGIONRESULTS_H
+#define REGIONSEEKER_REGIONRESULTS_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define REGION_RESULTS_MAGIC    "RSRESULT"
+#define REGION_RESULTS_VERSION  1
+
+// Columns of the format. New columns get new ids; readers skip ids they do
+// not know and get nullptr for columns a chunk does not have.
+enum RegionResultsColumnId : uint32_t {
+  RRC_Function = 0,   // u32  Index in the Function table.
+  RRC_Name,           // u32  Offset of "entry => exit" in the string table.
+  RRC_Parent,         // i32  Row of the closest enclosing Region that has results, -1 if none.
+  RRC_Depth,          // u32  Depth in the Region tree.
+  RRC_Speedup,        // i64  Cycles saved: SWCost - HWCost - Overhead.
+  RRC_SWCost,         // i64  Software Cost in Cycles.
+  RRC_HWCost,         // i64  Hardware Cost in Cycles.
+  RRC_Overhead,       // i64  Invocation Overhead in Cycles.
+  RRC_Area,           // u32  Area in LUTs.
+  RRC_Freq,           // f64  Total Frequency of the Region.
+  RRC_Inputs,         // u32  Data Flow Inputs.
+  RRC_Outputs,        // u32  Data Flow Outputs.
+  RRC_Loads,          // u32
+  RRC_Stores,         // u32
+  RRC_NumColumns
+};
+
+enum RegionResultsType : uint32_t { RRT_U32 = 0, RRT_I32, RRT_I64, RRT_F64 };
+
+struct RegionResultsHeader {
+
+  char     Magic[8];          // REGION_RESULTS_MAGIC, not NUL terminated.
+  uint32_t Version;
+  uint32_t HeaderSize;        // sizeof(RegionResultsHeader)
+  uint64_t ChunkSize;         // Size of the chunk in bytes, header included.
+  uint32_t NumFunctions;
+  uint32_t NumRegions;
+  uint32_t NumColumns;
+  uint32_t StringTableSize;
+  uint64_t FunctionsOffset;
+  uint64_t ColumnsOffset;
+  uint64_t StringsOffset;
+};
+
+// Flags of a RegionResultsFunction.
+enum RegionResultsFunctionFlags : uint32_t {
+  RRF_Partial = 1             // Not all Regions were analyzed, e.g. a time budget ran out.
+};
+
+struct RegionResultsFunction {
+
+  uint32_t Name;              // Offset in the string table.
+  uint32_t FirstRegion;       // Row of the first Region of the Function.
+  uint32_t NumRegions;
+  uint32_t Flags;             // RegionResultsFunctionFlags, 0 in files written before they existed.
+};
+
+struct RegionResultsColumn {
+
+  uint32_t Id;                // RegionResultsColumnId
+  uint32_t Type;              // RegionResultsType
+  uint64_t Offset;            // Offset of the NumRegions values.
+};
+
+// Type of each column, indexed by RegionResultsColumnId.
+static const RegionResultsType RegionResultsColumnTypes[RRC_NumColumns] = {
+  RRT_U32, RRT_U32, RRT_I32, RRT_U32, RRT_I64, RRT_I64, RRT_I64, RRT_I64,
+  RRT_U32, RRT_F64, RRT_U32, RRT_U32, RRT_U32, RRT_U32
+};
+
+inline unsigned getRegionResultsTypeSize(uint32_t Type) {
+
+  return (Type == RRT_I64 || Type == RRT_F64) ? 8 : 4;
+}
+
+// Results of one Region, as handed to the writer.
+struct RegionResultRow {
+
+  uint32_t Name;              // From RegionResultsWriter::intern.
+  int32_t  Parent;
+  uint32_t Depth;
+  int64_t  Speedup;
+  int64_t  SWCost;
+  int64_t  HWCost;
+  int64_t  Overhead;
+  uint32_t Area;
+  double   Freq;
+  uint32_t Inputs;
+  uint32_t Outputs;
+  uint32_t Loads;
+  uint32_t Stores;
+
+  RegionResultRow() : Name(0), Parent(-1), Depth(0), Speedup(0), SWCost(0), HWCost(0), Overhead(0),
+                      Area(0), Freq(0), Inputs(0), Outputs(0), Loads(0), Stores(0) {}
+};
+
+// Collects the Regions of a Module and appends them as one chunk.
+class RegionResultsWriter {
+
+  std::vector<RegionResultsFunction> Functions;
+  std::vector<RegionResultRow> Rows;
+  std::vector<uint32_t> RowFunction;
+  std::string Strings;
+  std::unordered_map<std::string, uint32_t> Interned;
+
+  static void pad(std::string &Out) {
+
+    while (Out.size() % 8)
+      Out.push_back('\0');
+  }
+
+  template <typename T>
+  static void put(std::string &Out, const T &Value) {
+
+    Out.append(reinterpret_cast<const char *>(&Value), sizeof(T));
+  }
+
+public:
+  uint32_t intern(const std::string &S) {
+
+    std::unordered_map<std::string, uint32_t>::iterator It = Interned.find(S);
+
+    if (It != Interned.end())
+      return It->second;
+
+    uint32_t Offset = Strings.size();
+    Strings.append(S.c_str(), S.size() + 1);
+    Interned[S] = Offset;
+
+    return Offset;
+  }
+
+  // Regions added from now on belong to Function Name.
+  void beginFunction(const std::string &Name, uint32_t Flags = 0) {
+
+    RegionResultsFunction F;
+    F.Name = intern(Name);
+    F.FirstRegion = Rows.size();
+    F.NumRegions = 0;
+    F.Flags = Flags;
+
+    Functions.push_back(F);
+  }
+
+  // @return  The row of the Region in the chunk, to be used as Parent.
+  int32_t addRegion(const RegionResultRow &Row) {
+
+    Functions.back().NumRegions++;
+    RowFunction.push_back(Functions.size() - 1);
+    Rows.push_back(Row);
+
+    return Rows.size() - 1;
+  }
+
+  bool empty() const { return Rows.empty(); }
+
+  // @return  The row the next Region added will get.
+  int32_t getNumRegions() const { return Rows.size(); }
+
+  // Serialize the collected Regions as one chunk.
+  void serialize(std::string &Out) const {
+
+    RegionResultsHeader H;
+    std::memset(&H, 0, sizeof(H));
+    std::memcpy(H.Magic, REGION_RESULTS_MAGIC, sizeof(H.Magic));
+    H.Version = REGION_RESULTS_VERSION;
+    H.HeaderSize = sizeof(H);
+    H.NumFunctions = Functions.size();
+    H.NumRegions = Rows.size();
+    H.NumColumns = RRC_NumColumns;
+    H.StringTableSize = Strings.size();
+    H.FunctionsOffset = sizeof(H);
+    H.ColumnsOffset = H.FunctionsOffset + Functions.size() * sizeof(RegionResultsFunction);
+
+    // Lay out the columns after the directory.
+    uint64_t Offset = H.ColumnsOffset + RRC_NumColumns * sizeof(RegionResultsColumn);
+    std::vector<RegionResultsColumn> Directory;
+
+    for (uint32_t Id = 0; Id < RRC_NumColumns; Id++) {
+
+      RegionResultsColumn C;
+      C.Id = Id;
+      C.Type = RegionResultsColumnTypes[Id];
+      C.Offset = Offset;
+      Directory.push_back(C);
+
+      Offset += Rows.size() * getRegionResultsTypeSize(C.Type);
+      Offset = (Offset + 7) & ~uint64_t(7);
+    }
+
+    H.StringsOffset = Offset;
+    H.ChunkSize = (Offset + Strings.size() + 7) & ~uint64_t(7);
+
+    size_t Start = Out.size();
+    Out.reserve(Start + H.ChunkSize);
+
+    put(Out, H);
+    for (unsigned i = 0; i < Functions.size(); i++)
+      put(Out, Functions[i]);
+    for (unsigned i = 0; i < Directory.size(); i++)
+      put(Out, Directory[i]);
+
+    // One column after the other.
+    for (uint32_t Id = 0; Id < RRC_NumColumns; Id++) {
+
+      for (unsigned i = 0; i < Rows.size(); i++) {
+
+        const RegionResultRow &R = Rows[i];
+
+        switch (Id) {
+          case RRC_Function: put(Out, RowFunction[i]); break;
+          case RRC_Name:     put(Out, R.Name);         break;
+          case RRC_Parent:   put(Out, R.Parent);       break;
+          case RRC_Depth:    put(Out, R.Depth);        break;
+          case RRC_Speedup:  put(Out, R.Speedup);      break;
+          case RRC_SWCost:   put(Out, R.SWCost);       break;
+          case RRC_HWCost:   put(Out, R.HWCost);       break;
+          case RRC_Overhead: put(Out, R.Overhead);     break;
+          case RRC_Area:     put(Out, R.Area);         break;
+          case RRC_Freq:     put(Out, R.Freq);         break;
+          case RRC_Inputs:   put(Out, R.Inputs);       break;
+          case RRC_Outputs:  put(Out, R.Outputs);      break;
+          case RRC_Loads:    put(Out, R.Loads);        break;
+          case RRC_Stores:   put(Out, R.Stores);       break;
+        }
+      }
+
+      pad(Out);
+    }
+
+    Out.append(Strings);
+    pad(Out);
+  }
+
+  // Append the collected Regions as one chunk to the file at Path, then start over.
+  //
+  // @return  false if the file could not be written.
+  bool append(const std::string &Path) {
+
+    std::string Chunk;
+    serialize(Chunk);
+
+    std::ofstream File(Path.c_str(), std::ofstream::out | std::ofstream::app | std::ofstream::binary);
+    File.write(Chunk.data(), Chunk.size());
+    File.close();
+
+    clear();
+
+    return !File.fail();
+  }
+
+  void clear() {
+
+    Functions.clear();
+    Rows.clear();
+    RowFunction.clear();
+    Strings.clear();
+    Interned.clear();
+  }
+};
+
+// One chunk of a mapped results file. Columns are read in place.
+class RegionResultsChunk {
+
+  const char *Base;
+  const RegionResultsHeader *Header;
+
+public:
+  RegionResultsChunk(const char *Base) : Base(Base), Header(reinterpret_cast<const RegionResultsHeader *>(Base)) {}
+
+  uint32_t getNumFunctions() const { return Header->NumFunctions; }
+  uint32_t getNumRegions() const { return Header->NumRegions; }
+
+  const RegionResultsFunction &getFunction(uint32_t i) const {
+
+    return reinterpret_cast<const RegionResultsFunction *>(Base + Header->FunctionsOffset)[i];
+  }
+
+  // @param  Offset  A Function Name or a value of the RRC_Name column,
+  //                 checked by RegionResultsReader to be in the string table.
+  const char *getString(uint32_t Offset) const { return Base + Header->StringsOffset + Offset; }
+
+  // @return  true if a Function of the chunk has partial results.
+  bool isPartial() const {
+
+    for (uint32_t i = 0; i < getNumFunctions(); i++)
+      if (getFunction(i).Flags & RRF_Partial)
+        return true;
+
+    return false;
+  }
+
+  // @return  The values of column Id, or nullptr if the chunk has no such column.
+  template <typename T>
+  const T *getColumn(RegionResultsColumnId Id) const {
+
+    const RegionResultsColumn *Directory = reinterpret_cast<const RegionResultsColumn *>(Base + Header->ColumnsOffset);
+
+    for (uint32_t i = 0; i < Header->NumColumns; i++)
+      if (Directory[i].Id == Id && getRegionResultsTypeSize(Directory[i].Type) == sizeof(T))
+        return reinterpret_cast<const T *>(Base + Directory[i].Offset);
+
+    return nullptr;
+  }
+};
+
+// Memory maps a results file and indexes its chunks.
+class RegionResultsReader {
+
+  const char *Data;
+  size_t Size;
+  std::vector<char> Buffer;   // Used where mmap is not available.
+  std::vector<RegionResultsChunk> Chunks;
+
+  RegionResultsReader(const RegionResultsReader &) = delete;
+  RegionResultsReader &operator=(const RegionResultsReader &) = delete;
+
+  bool map(const std::string &Path) {
+
+#ifndef _WIN32
+    int FD = ::open(Path.c_str(), O_RDONLY);
+    if (FD < 0)
+      return false;
+
+    struct stat St;
+    if (::fstat(FD, &St) != 0) {
+      ::close(FD);
+      return false;
+    }
+
+    Size = St.st_size;
+    void *Map = Size ? ::mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, FD, 0) : nullptr;
+    ::close(FD);
+
+    if (Size && Map == MAP_FAILED)
+      return false;
+
+    Data = static_cast<const char *>(Map);
+#else
+    std::ifstream File(Path.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!File)
+      return false;
+
+    Buffer.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+    Data = Buffer.data();
+    Size = Buffer.size();
+#endif
+    return true;
+  }
+
+  void unmap() {
+
+#ifndef _WIN32
+    if (Data && Size)
+      ::munmap(const_cast<char *>(Data), Size);
+#endif
+    Data = nullptr;
+    Size = 0;
+    Buffer.clear();
+    Chunks.clear();
+  }
+
+  // @return  true if Size bytes at Offset lie inside a chunk of ChunkSize
+  //          bytes, without overflowing.
+  static bool isInChunk(uint64_t Offset, uint64_t Size, uint64_t ChunkSize) {
+
+    return Offset <= ChunkSize && Size <= ChunkSize - Offset;
+  }
+
+  // Every table of the chunk must lie inside it and be aligned for its
+  // values, the string table must end with a NUL and every string offset
+  // must lie inside the string table, so RegionResultsChunk need not check
+  // anything. Chunks start at multiples of 8 in the file, and the file is
+  // mapped or read at an address aligned at least as much.
+  static bool isChunkValid(const RegionResultsHeader *H) {
+
+    const char *Base = reinterpret_cast<const char *>(H);
+    const RegionResultsColumn *Directory = reinterpret_cast<const RegionResultsColumn *>(Base + H->ColumnsOffset);
+    const RegionResultsFunction *Functions = reinterpret_cast<const RegionResultsFunction *>(Base + H->FunctionsOffset);
+
+    if (H->HeaderSize < sizeof(RegionResultsHeader) || H->FunctionsOffset % 8 || H->ColumnsOffset % 8 ||
+        !isInChunk(H->FunctionsOffset, uint64_t(H->NumFunctions) * sizeof(RegionResultsFunction), H->ChunkSize) ||
+        !isInChunk(H->ColumnsOffset, uint64_t(H->NumColumns) * sizeof(RegionResultsColumn), H->ChunkSize) ||
+        !isInChunk(H->StringsOffset, H->StringTableSize, H->ChunkSize))
+      return false;
+
+    if (H->StringTableSize && Base[H->StringsOffset + H->StringTableSize - 1] != '\0')
+      return false;
+
+    for (uint32_t i = 0; i < H->NumFunctions; i++)
+      if (Functions[i].Name >= H->StringTableSize)
+        return false;
+
+    for (uint32_t i = 0; i < H->NumColumns; i++) {
+
+      unsigned TypeSize = getRegionResultsTypeSize(Directory[i].Type);
+
+      if (Directory[i].Offset % TypeSize ||
+          !isInChunk(Directory[i].Offset, uint64_t(H->NumRegions) * TypeSize, H->ChunkSize))
+        return false;
+
+      // getColumn only hands out columns whose values have the expected size.
+      if (Directory[i].Id == RRC_Name && TypeSize == sizeof(uint32_t)) {
+
+        const uint32_t *Names = reinterpret_cast<const uint32_t *>(Base + Directory[i].Offset);
+
+        for (uint32_t r = 0; r < H->NumRegions; r++)
+          if (Names[r] >= H->StringTableSize)
+            return false;
+      }
+    }
+
+    return true;
+  }
+
+public:
+  RegionResultsReader() : Data(nullptr), Size(0) {}
+  ~RegionResultsReader() { unmap(); }
+
+  // @return  false, with Error set, if the file cannot be read or is malformed.
+  bool open(const std::string &Path, std::string &Error) {
+
+    unmap();
+
+    if (!map(Path)) {
+      Error = "cannot read '" + Path + "'";
+      return false;
+    }
+
+    for (uint64_t Offset = 0; Offset < Size; ) {
+
+      const RegionResultsHeader *H = reinterpret_cast<const RegionResultsHeader *>(Data + Offset);
+
+      if (Size - Offset < sizeof(RegionResultsHeader) || std::memcmp(H->Magic, REGION_RESULTS_MAGIC, sizeof(H->Magic))) {
+        Error = "'" + Path + "' is not a Region results file";
+        return false;
+      }
+
+      if (H->Version != REGION_RESULTS_VERSION) {
+        Error = "'" + Path + "' has unsupported version " + std::to_string(H->Version);
+        return false;
+      }
+
+      if (H->ChunkSize > Size - Offset) {
+        Error = "'" + Path + "' is truncated";
+        return false;
+      }
+
+      if (H->ChunkSize < H->HeaderSize || H->ChunkSize % 8 || !isChunkValid(H)) {
+        Error = "'" + Path + "' is malformed";
+        return false;
+      }
+
+      Chunks.push_back(RegionResultsChunk(Data + Offset));
+      Offset += H->ChunkSize;
+    }
+
+    return true;
+  }
+
+  const std::vector<RegionResultsChunk> &getChunks() const { return Chunks; }
+
+  uint64_t getNumRegions() const {
+
+    uint64_t N = 0;
+
+    for (unsigned i = 0; i < Chunks.size(); i++)
+      N += Chunks[i].getNumRegions();
+
+    return N;
+  }
+};
+
+#endif
@@ -0,0 +1,222 @@
+//===--------------------------- RegionSelect.cpp ---------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Selects the Regions to implement in hardware from the Region results of the
+// IdentifyRegions pass (Regions.bin): the set of Regions, no two of them
+// nested, with the largest total speedup whose area fits the budget, or
+// quickly a good such set with -mode greedy.
+//
+//   RegionSelect -budget <LUTs> [-mode exact|greedy|pareto] [-score ratio|speedup]
+//                [-max-nodes <n>] [-resolution <LUTs>] [-o <file>] <Regions.bin>...
+//
+// The selected Regions are written one per line, in pre-order for exact and
+// in the order they were picked for greedy, with the speedup and area
+// accumulated so far:
+//
+//   Function <tab> Region <tab> Speedup <tab> Area <tab> Total Speedup <tab> Total Area
+//
+// -mode pareto writes instead the speedup against area Pareto frontier of
+// the selections up to the budget, with the areas of the Regions rounded up
+// to the resolution, one point per line:
+//
+//   Budget <tab> Speedup <tab> Area <tab> Regions
+//
+// Budget is the smallest multiple of the resolution the selection fits in,
+// Area its exact area.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../RegionSelection.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+  struct Options {
+
+    std::string Mode;                   // exact, greedy or pareto
+    SelectionScore Score;               // Greedy only.
+    uint64_t Resolution;                // Pareto only, 0 for Budget / 1000.
+    std::string Output;                 // stdout if empty.
+    uint64_t Budget;
+    uint64_t MaxNodes;                  // 0 for no limit.
+    bool HasBudget;
+    std::vector<std::string> Inputs;
+
+    Options() : Mode("exact"), Score(SS_Ratio), Resolution(0), Budget(0), MaxNodes(0), HasBudget(false) {}
+  };
+
+  void printUsage(const char *Argv0) {
+
+    std::cerr << "usage: " << Argv0 << " -budget <LUTs> [-mode exact|greedy|pareto] [-score ratio|speedup]"
+              << " [-max-nodes <n>] [-resolution <LUTs>] [-o <file>] <Regions.bin>...\n";
+  }
+
+  // @return  false if the command line is malformed.
+  bool parseOptions(int argc, char **argv, Options &Opts) {
+
+    for (int i = 1; i < argc; i++) {
+
+      std::string Arg = argv[i];
+      bool HasValue = i + 1 < argc;
+
+      if (Arg == "-budget" && HasValue) {
+        Opts.Budget = std::strtoull(argv[++i], nullptr, 10);
+        Opts.HasBudget = true;
+      }
+      else if (Arg == "-mode" && HasValue)
+        Opts.Mode = argv[++i];
+      else if (Arg == "-score" && HasValue) {
+        std::string Score = argv[++i];
+        if (Score == "ratio")
+          Opts.Score = SS_Ratio;
+        else if (Score == "speedup")
+          Opts.Score = SS_Speedup;
+        else
+          return false;
+      }
+      else if (Arg == "-max-nodes" && HasValue)
+        Opts.MaxNodes = std::strtoull(argv[++i], nullptr, 10);
+      else if (Arg == "-resolution" && HasValue)
+        Opts.Resolution = std::strtoull(argv[++i], nullptr, 10);
+      else if (Arg == "-o" && HasValue)
+        Opts.Output = argv[++i];
+      else if (!Arg.empty() && Arg[0] != '-')
+        Opts.Inputs.push_back(Arg);
+      else
+        return false;
+    }
+
+    return Opts.HasBudget && (Opts.Mode == "exact" || Opts.Mode == "greedy" || Opts.Mode == "pareto") && !Opts.Inputs.empty();
+  }
+
+  void writeSelection(const SelectionCandidates &C, const Selection &S, std::ostream &Out) {
+
+    int64_t Speedup = 0;
+    uint64_t Area = 0;
+
+    for (unsigned i = 0; i < S.Regions.size(); i++) {
+
+      unsigned R = S.Regions[i];
+
+      Speedup += C.Speedup[R];
+      Area += C.Area[R];
+
+      Out << C.Function[R] << "\t" << C.Name[R] << "\t" << C.Speedup[R] << "\t" << C.Area[R] << "\t"
+          << Speedup << "\t" << Area << "\n";
+    }
+  }
+
+  void writeFrontier(const std::vector<ParetoPoint> &Frontier, uint64_t Resolution, std::ostream &Out) {
+
+    for (unsigned j = 0; j < Frontier.size(); j++) {
+
+      const ParetoPoint &P = Frontier[j];
+
+      Out << P.Units * Resolution << "\t" << P.Speedup << "\t" << P.Area << "\t" << P.Regions << "\n";
+    }
+  }
+
+} // End of anonymous namespace
+
+int main(int argc, char **argv) {
+
+  Options Opts;
+
+  if (!parseOptions(argc, argv, Opts)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  SelectionCandidates Candidates;
+
+  for (unsigned i = 0; i < Opts.Inputs.size(); i++) {
+
+    RegionResultsReader Results;
+    std::string Error;
+
+    if (!Results.open(Opts.Inputs[i], Error)) {
+      std::cerr << argv[0] << ": " << Error << "\n";
+      return 1;
+    }
+
+    if (!loadSelectionCandidates(Results, Candidates, Error)) {
+      std::cerr << argv[0] << ": '" << Opts.Inputs[i] << "': " << Error << "\n";
+      return 1;
+    }
+
+    for (unsigned c = 0; c < Results.getChunks().size(); c++)
+      if (Results.getChunks()[c].isPartial()) {
+        std::cerr << argv[0] << ": '" << Opts.Inputs[i] << "': partial results, not all Regions were analyzed\n";
+        break;
+      }
+  }
+
+  std::ofstream File;
+
+  if (!Opts.Output.empty()) {
+    File.open(Opts.Output.c_str(), std::ofstream::out | std::ofstream::trunc);
+
+    if (!File.is_open()) {
+      std::cerr << argv[0] << ": cannot write '" << Opts.Output << "'\n";
+      return 1;
+    }
+  }
+
+  std::ostream &Out = Opts.Output.empty() ? std::cout : File;
+  std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+  double Seconds;
+
+  if (Opts.Mode == "pareto") {
+
+    uint64_t Resolution = Opts.Resolution ? Opts.Resolution : std::max<uint64_t>(1, Opts.Budget / 1000);
+    std::vector<ParetoPoint> Frontier;
+
+    getParetoFrontier(Candidates, Opts.Budget, Resolution, Frontier);
+    Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    writeFrontier(Frontier, Resolution, Out);
+
+    std::cerr << "pareto: " << Frontier.size() << " points of " << Candidates.size() << " Regions, Speedup "
+              << Frontier.back().Speedup << ", Area " << Frontier.back().Area << " of " << Opts.Budget
+              << ", resolution " << Resolution << " LUTs in " << Seconds << " s\n";
+  }
+  else {
+
+    Selection Selected;
+
+    if (Opts.Mode == "greedy")
+      GreedySelector(Candidates, Opts.Score).select(Opts.Budget, Selected);
+    else
+      ExactSelector(Candidates).select(Opts.Budget, Opts.MaxNodes, Selected);
+
+    Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    writeSelection(Candidates, Selected, Out);
+
+    std::cerr << Opts.Mode << ": " << Selected.Regions.size() << " of " << Candidates.size() << " Regions, Speedup "
+              << Selected.Speedup << ", Area " << Selected.Area << " of " << Opts.Budget << ", ";
+
+    if (Opts.Mode == "exact")
+      std::cerr << (Selected.Optimal ? "optimal" : "node limit reached") << " after " << Selected.Nodes << " nodes ";
+
+    std::cerr << "in " << Seconds << " s\n";
+  }
+
+  Out.flush();
+
+  if (!Out) {
+    std::cerr << argv[0] << ": cannot write '" << (Opts.Output.empty() ? "<stdout>" : Opts.Output) << "'\n";
+    return 1;
+  }
+
+  return 0;
+}
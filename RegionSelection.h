@@ -0,0 +1,800 @@
+//===--------------------------- RegionSelection.h ---------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Selection of the Regions to implement in hardware, from the Region results
+// written by the IdentifyRegions pass (Regions.bin). A Region and the Regions
+// nested in it are alternatives, at most one of them is implemented, so a
+// selection is an antichain of the Region forest. Among those that fit an
+// area budget the one with the largest total speedup is wanted.
+//
+// Candidates are kept in the pre-order of the Region forest, as in the
+// results file, so the Regions nested in candidate i are exactly the
+// candidates i+1 ... End[i]-1. Depends on the C++ standard library only.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef REGIONSEEKER_REGIONSELECTION_H
+#define REGIONSEEKER_REGIONSELECTION_H
+
+#include "RegionResults.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The Regions that can be selected, in pre-order of the Region forest.
+struct SelectionCandidates {
+
+  std::vector<std::string> Function;
+  std::vector<std::string> Name;          // "entry => exit"
+  std::vector<int64_t>     Speedup;       // Cycles saved.
+  std::vector<uint64_t>    Area;          // Area in LUTs.
+  std::vector<int32_t>     Parent;        // Closest enclosing candidate, -1 if none.
+  std::vector<uint32_t>    End;           // One past the last candidate nested in it.
+
+  unsigned size() const { return Speedup.size(); }
+
+  void clear() { *this = SelectionCandidates(); }
+
+  // Compute End from Parent. Children come after their parent in pre-order,
+  // so a reverse walk finishes every child before it is folded into its parent.
+  void buildEnds() {
+
+    End.resize(size());
+
+    for (unsigned i = 0; i < size(); i++)
+      End[i] = i + 1;
+
+    for (unsigned i = size(); i-- > 0; )
+      if (Parent[i] >= 0)
+        End[Parent[i]] = std::max(End[Parent[i]], End[i]);
+  }
+
+  // The candidates Keep as candidates of their own, in that order, which must
+  // be a pre-order of the Regions kept: siblings may be reordered. The Parent
+  // of each is its closest enclosing candidate that is kept.
+  void getSubset(const std::vector<unsigned> &Keep, SelectionCandidates &Sub) const {
+
+    std::vector<int32_t> Index(size(), -1);
+
+    Sub.clear();
+
+    for (unsigned j = 0; j < Keep.size(); j++) {
+
+      unsigned i = Keep[j];
+      int32_t P = Parent[i];
+
+      while (P >= 0 && Index[P] < 0)
+        P = Parent[P];
+
+      Index[i] = j;
+      Sub.Function.push_back(Function[i]);
+      Sub.Name.push_back(Name[i]);
+      Sub.Speedup.push_back(Speedup[i]);
+      Sub.Area.push_back(Area[i]);
+      Sub.Parent.push_back(P < 0 ? -1 : Index[P]);
+    }
+
+    Sub.buildEnds();
+  }
+};
+
+// Append the Regions of every chunk of Results to Candidates.
+//
+// @return  false, with Error set, if a chunk lacks a column the selection needs.
+inline bool loadSelectionCandidates(const RegionResultsReader &Results, SelectionCandidates &Candidates, std::string &Error) {
+
+  const std::vector<RegionResultsChunk> &Chunks = Results.getChunks();
+
+  for (unsigned c = 0; c < Chunks.size(); c++) {
+
+    const RegionResultsChunk &Chunk = Chunks[c];
+    const uint32_t *Names    = Chunk.getColumn<uint32_t>(RRC_Name);
+    const int32_t  *Parents  = Chunk.getColumn<int32_t>(RRC_Parent);
+    const int64_t  *Speedups = Chunk.getColumn<int64_t>(RRC_Speedup);
+    const uint32_t *Areas    = Chunk.getColumn<uint32_t>(RRC_Area);
+
+    if (!Names || !Parents || !Speedups || !Areas) {
+      Error = "results lack the Name, Parent, Speedup or Area of the Regions";
+      return false;
+    }
+
+    int32_t Base = Candidates.size();
+    std::vector<int64_t> RowFunction(Chunk.getNumRegions(), -1);
+
+    for (uint32_t f = 0; f < Chunk.getNumFunctions(); f++) {
+
+      const RegionResultsFunction &F = Chunk.getFunction(f);
+
+      if (uint64_t(F.FirstRegion) + F.NumRegions > Chunk.getNumRegions()) {
+        Error = "results have a Function with Regions out of range";
+        return false;
+      }
+
+      for (uint32_t r = F.FirstRegion; r < F.FirstRegion + F.NumRegions; r++)
+        RowFunction[r] = f;
+    }
+
+    for (uint32_t r = 0; r < Chunk.getNumRegions(); r++) {
+
+      // A Parent must come earlier, in the same Function.
+      if (RowFunction[r] < 0 || Parents[r] >= static_cast<int64_t>(r) ||
+          (Parents[r] >= 0 && RowFunction[Parents[r]] != RowFunction[r])) {
+        Error = "results have a Region outside any Function or not after its Parent";
+        return false;
+      }
+
+      Candidates.Function.push_back(Chunk.getString(Chunk.getFunction(RowFunction[r]).Name));
+      Candidates.Name.push_back(Chunk.getString(Names[r]));
+      Candidates.Speedup.push_back(Speedups[r]);
+      Candidates.Area.push_back(Areas[r]);
+      Candidates.Parent.push_back(Parents[r] < 0 ? -1 : Base + Parents[r]);
+    }
+  }
+
+  Candidates.buildEnds();
+
+  return true;
+}
+
+// What the greedy selection ranks the candidates by.
+enum SelectionScore {
+  SS_Ratio,                     // Speedup per Area, free candidates count as one LUT.
+  SS_Speedup
+};
+
+// Selected candidates and their totals. The exact selection lists them in
+// pre-order, the greedy one in the order they were picked.
+struct Selection {
+
+  std::vector<unsigned> Regions;
+  int64_t  Speedup;
+  uint64_t Area;
+  bool     Optimal;             // Proven optimal, false if the search was cut short or greedy.
+  uint64_t Nodes;               // Nodes of the search tree that were visited.
+
+  Selection() : Speedup(0), Area(0), Optimal(false), Nodes(0) {}
+};
+
+
+namespace {
+
+  // The best antichain of every suffix i ... n-1 of the candidates when
+  // candidate j is worth Speedup[j] - Lambda * Area[j] and there is no
+  // budget. Candidates worth nothing are never taken. Value[i] is what the
+  // antichain of suffix i is worth, Take[i] whether it contains candidate i
+  // and Area[i] its area. Prefix[i] is what the best antichain of the
+  // candidates that end before i, i.e. End[k] <= i, is worth.
+  //
+  // For any Lambda >= 0, an antichain of suffix i that fits in Budget has a
+  // speedup of at most Value[i] + Lambda * Budget: this is the Lagrangian
+  // relaxation of the budget, and with Lambda = 0 plainly the best speedup
+  // without a budget.
+  struct AntichainTable {
+
+    double Lambda;
+    std::vector<double>   Value;
+    std::vector<double>   Prefix;
+    std::vector<uint64_t> Area;
+    std::vector<bool>     Take;
+
+    double getWorth(const SelectionCandidates &C, unsigned i) const {
+
+      return static_cast<double>(C.Speedup[i]) - Lambda * static_cast<double>(C.Area[i]);
+    }
+
+    void build(const SelectionCandidates &C, double L) {
+
+      unsigned N = C.size();
+
+      Lambda = L;
+      Value.assign(N + 1, 0);
+      Prefix.assign(N + 1, 0);
+      Area.assign(N + 1, 0);
+      Take.assign(N, false);
+
+      for (unsigned i = N; i-- > 0; ) {
+
+        double Worth = getWorth(C, i);
+        double Taken = Worth + Value[C.End[i]];
+
+        if (Worth > 0 && Taken > Value[i+1]) {
+          Take[i]  = true;
+          Value[i] = Taken;
+          Area[i]  = C.Area[i] + Area[C.End[i]];
+        }
+        else {
+          Value[i] = Value[i+1];
+          Area[i]  = Area[i+1];
+        }
+      }
+
+      // Candidate k ends at End[k] > k, so visiting them in order of End,
+      // Prefix[k] is final before k is folded in.
+      std::vector<unsigned> ByEnd(N);
+
+      for (unsigned i = 0; i < N; i++)
+        ByEnd[i] = i;
+
+      std::stable_sort(ByEnd.begin(), ByEnd.end(),
+                       [&C](unsigned A, unsigned B) { return C.End[A] < C.End[B]; });
+
+      unsigned i = 0;
+
+      for (unsigned e = 1; e <= N; e++) {
+
+        Prefix[e] = Prefix[e-1];
+
+        for (; i < N && C.End[ByEnd[i]] == e; i++) {
+
+          unsigned k = ByEnd[i];
+          double Worth = getWorth(C, k);
+
+          if (Worth > 0)
+            Prefix[e] = std::max(Prefix[e], Worth + Prefix[k]);
+        }
+      }
+    }
+
+    // Bound on the speedup of any antichain that contains candidate i and
+    // fits in Budget: the candidates that are not nested with i are the ones
+    // that end before it and the ones after its nested Regions.
+    double getBoundWith(const SelectionCandidates &C, unsigned i, uint64_t Budget) const {
+
+      return getWorth(C, i) + Prefix[i] + Value[C.End[i]] + Lambda * static_cast<double>(Budget);
+    }
+
+    // Append the antichain of suffix i to Regions.
+    void getAntichain(const SelectionCandidates &C, unsigned i, std::vector<unsigned> &Regions) const {
+
+      while (i < C.size()) {
+
+        if (Take[i]) {
+          Regions.push_back(i);
+          i = C.End[i];
+        }
+        else
+          i++;
+      }
+    }
+  };
+
+  // The multiplier whose bound for suffix 0 and Budget is tightest: the
+  // bound is convex in Lambda and its slope is Budget minus the area of the
+  // antichain, so bisect on where that area crosses Budget. The antichain at
+  // the upper end fits in Budget, its table is returned in Fitting.
+  double getBestLambda(const SelectionCandidates &C, uint64_t Budget, AntichainTable &Fitting) {
+
+    double Lo = 0, Hi = 0;
+
+    for (unsigned i = 0; i < C.size(); i++)
+      if (C.Speedup[i] > 0)
+        Hi = std::max(Hi, static_cast<double>(C.Speedup[i]) / std::max<double>(C.Area[i], 1));
+
+    // Well beyond the best ratio, rounding aside, only free candidates are
+    // worth taking.
+    Hi = 2 * Hi + 1;
+    Fitting.build(C, Hi);
+
+    for (unsigned Iter = 0; Iter < 64 && Hi - Lo > 1e-9 * Hi; Iter++) {
+
+      AntichainTable Mid;
+      Mid.build(C, (Lo + Hi) / 2);
+
+      if (Mid.Area[0] > Budget)
+        Lo = Mid.Lambda;
+      else {
+        Hi = Mid.Lambda;
+        Fitting = Mid;
+      }
+    }
+
+    return Hi;
+  }
+
+  // Speedup per Area of candidate i, free candidates count as one LUT.
+  double getRatio(const SelectionCandidates &C, unsigned i) {
+
+    return static_cast<double>(C.Speedup[i]) / std::max<double>(C.Area[i], 1);
+  }
+
+  // A pre-order of the candidates in which siblings, top level candidates
+  // included, come in order of the best ratio among them and the candidates
+  // nested in them.
+  void getOrderByRatio(const SelectionCandidates &C, std::vector<unsigned> &Order) {
+
+    unsigned N = C.size();
+    std::vector<double> Best(N);
+    std::vector<std::vector<unsigned> > Children(N + 1); // Children[N] are the top level candidates.
+
+    for (unsigned i = 0; i < N; i++)
+      Best[i] = getRatio(C, i);
+
+    for (unsigned i = N; i-- > 0; )
+      if (C.Parent[i] >= 0)
+        Best[C.Parent[i]] = std::max(Best[C.Parent[i]], Best[i]);
+
+    for (unsigned i = 0; i < N; i++)
+      Children[C.Parent[i] < 0 ? N : C.Parent[i]].push_back(i);
+
+    std::vector<unsigned> Stack;
+    Order.clear();
+
+    for (unsigned i = N + 1; i-- > 0; ) {
+
+      std::stable_sort(Children[i].begin(), Children[i].end(),
+                       [&Best](unsigned A, unsigned B) { return Best[A] > Best[B]; });
+
+      if (i == N)
+        Stack.assign(Children[N].rbegin(), Children[N].rend());
+    }
+
+    while (!Stack.empty()) {
+
+      unsigned i = Stack.back();
+      Stack.pop_back();
+
+      Order.push_back(i);
+      Stack.insert(Stack.end(), Children[i].rbegin(), Children[i].rend());
+    }
+  }
+
+  // Add candidates to the antichain Regions, best Speedup per Area first,
+  // as long as they fit in Budget and are not nested with one already in.
+  void fillGreedily(const SelectionCandidates &C, uint64_t Budget, std::vector<unsigned> &Regions) {
+
+    std::vector<bool> Selected(C.size(), false), Below(C.size(), false);
+    std::vector<unsigned> Order;
+    uint64_t Area = 0;
+
+    for (unsigned j = 0; j < Regions.size(); j++) {
+      Selected[Regions[j]] = true;
+      Area += C.Area[Regions[j]];
+    }
+
+    for (unsigned i = 0; i < C.size(); i++) {
+
+      if (Selected[i])
+        for (int32_t P = C.Parent[i]; P >= 0; P = C.Parent[P])
+          Below[P] = true;
+
+      if (C.Speedup[i] > 0)
+        Order.push_back(i);
+    }
+
+    std::stable_sort(Order.begin(), Order.end(), [&C](unsigned A, unsigned B) {
+      return static_cast<double>(C.Speedup[A]) * std::max<double>(C.Area[B], 1) >
+             static_cast<double>(C.Speedup[B]) * std::max<double>(C.Area[A], 1);
+    });
+
+    for (unsigned j = 0; j < Order.size(); j++) {
+
+      unsigned i = Order[j];
+      bool Nested = Selected[i] || Below[i];
+
+      for (int32_t P = C.Parent[i]; P >= 0 && !Nested; P = C.Parent[P])
+        Nested = Selected[P];
+
+      if (Nested || C.Area[i] > Budget - Area)
+        continue;
+
+      Selected[i] = true;
+      Area += C.Area[i];
+      Regions.push_back(i);
+
+      for (int32_t P = C.Parent[i]; P >= 0; P = C.Parent[P])
+        Below[P] = true;
+    }
+
+    std::sort(Regions.begin(), Regions.end());
+  }
+
+  // Exact selection by branch-and-bound.
+  //
+  // A first selection comes from the Lagrangian relaxation of the budget,
+  // completed greedily. Every candidate whose bound when it is taken cannot
+  // beat it is dropped for good (reduced cost fixing), which on real
+  // applications leaves a small fraction of the candidates.
+  //
+  // The rest are searched depth first in pre-order. A node of the search is a
+  // position i and the budget left: candidate i is either taken, which
+  // excludes the Regions nested in it and continues at End[i], or skipped,
+  // which continues at i+1. Candidates that do not fit are skipped without
+  // branching. A node is cut when the bound on its suffix, the smallest
+  // Lagrangian bound over multipliers spread around the tightest one, cannot
+  // beat the best selection so far; each is an O(1) lookup in a precomputed
+  // AntichainTable. A node is closed at once when the best antichain of its
+  // suffix without a budget fits anyway.
+  //
+  // The search stops after MaxNodes nodes (0 for no limit); the best
+  // selection found is returned then, with Optimal unset.
+  class ExactSelector {
+
+    const SelectionCandidates &C;
+
+    // Multipliers of the bounds, relative to the tightest one. Smaller
+    // budgets are left deeper in the search, they need larger multipliers.
+    static const unsigned NumScales = 9;
+
+    static double getScale(unsigned k) {
+
+      static const double Scales[NumScales] = { 0, 0.5, 0.8, 1, 1.25, 1.6, 2, 4, 8 };
+      return Scales[k];
+    }
+
+    static void record(const SelectionCandidates &S, const std::vector<unsigned> &Regions, Selection &Best) {
+
+      Best.Regions = Regions;
+      Best.Speedup = 0;
+      Best.Area = 0;
+
+      for (unsigned j = 0; j < Regions.size(); j++) {
+        Best.Speedup += S.Speedup[Regions[j]];
+        Best.Area += S.Area[Regions[j]];
+      }
+    }
+
+    // Branch-and-bound over the candidates S, improving on Best, a selection of S.
+    static void search(const SelectionCandidates &S, uint64_t Budget, uint64_t MaxNodes, Selection &Best) {
+
+      AntichainTable Fitting;
+      double Lambda = getBestLambda(S, Budget, Fitting);
+      std::vector<AntichainTable> Tables(NumScales);
+
+      for (unsigned k = 0; k < NumScales; k++)
+        Tables[k].build(S, Lambda * getScale(k));
+
+      // Depth first, taking before skipping. The stack holds the skip
+      // branches still to search, with the length of the Path they extend.
+      struct Node {
+        unsigned Pos;
+        uint64_t Budget;
+        int64_t  Speedup;
+        unsigned PathSize;
+      };
+
+      std::vector<unsigned> Path;
+      std::vector<Node> Stack;
+      Node Root = { 0, Budget, 0, 0 };
+      Stack.push_back(Root);
+
+      while (!Stack.empty()) {
+
+        Node N = Stack.back();
+        Stack.pop_back();
+        Path.resize(N.PathSize);
+
+        while (true) {
+
+          while (N.Pos < S.size() && S.Area[N.Pos] > N.Budget)
+            N.Pos++;
+
+          if (N.Pos == S.size()) {
+            if (N.Speedup > Best.Speedup)
+              record(S, Path, Best);
+            break;
+          }
+
+          double Bound = Tables[0].Value[N.Pos];
+
+          for (unsigned k = 1; k < NumScales; k++)
+            Bound = std::min(Bound, Tables[k].Value[N.Pos] + Tables[k].Lambda * static_cast<double>(N.Budget));
+
+          // The speedups are integers, improving on Best means reaching Best + 1.
+          if (N.Speedup + Bound < Best.Speedup + 0.5)
+            break;
+
+          if (Tables[0].Area[N.Pos] <= N.Budget) {
+            unsigned Size = Path.size();
+            Tables[0].getAntichain(S, N.Pos, Path);
+            if (N.Speedup + Tables[0].Value[N.Pos] > Best.Speedup)
+              record(S, Path, Best);
+            Path.resize(Size);
+            break;
+          }
+
+          if (MaxNodes && Best.Nodes >= MaxNodes) {
+            Best.Optimal = false;
+            return;
+          }
+
+          Best.Nodes++;
+
+          Node Skip = { N.Pos + 1, N.Budget, N.Speedup, static_cast<unsigned>(Path.size()) };
+          Stack.push_back(Skip);
+
+          Path.push_back(N.Pos);
+          N.Budget  -= S.Area[N.Pos];
+          N.Speedup += S.Speedup[N.Pos];
+          N.Pos      = S.End[N.Pos];
+        }
+      }
+    }
+
+  public:
+    ExactSelector(const SelectionCandidates &C) : C(C) {}
+
+    void select(uint64_t Budget, uint64_t MaxNodes, Selection &Best) {
+
+      Best = Selection();
+      Best.Optimal = true;
+
+      AntichainTable Zero;
+      Zero.build(C, 0);
+
+      // Without a budget problem there is nothing to search.
+      if (Zero.Area[0] <= Budget) {
+        std::vector<unsigned> Regions;
+        Zero.getAntichain(C, 0, Regions);
+        record(C, Regions, Best);
+        return;
+      }
+
+      // A first selection, then drop the candidates that cannot improve on it.
+      AntichainTable Fitting;
+      double Lambda = getBestLambda(C, Budget, Fitting);
+      std::vector<unsigned> Regions, Keep, Order;
+
+      Fitting.getAntichain(C, 0, Regions);
+      fillGreedily(C, Budget, Regions);
+      record(C, Regions, Best);
+
+      std::vector<AntichainTable> Tables(NumScales);
+
+      for (unsigned k = 0; k < NumScales; k++)
+        Tables[k].build(C, Lambda * getScale(k));
+
+      for (unsigned i = 0; i < C.size(); i++) {
+
+        if (C.Speedup[i] <= 0 || C.Area[i] > Budget)
+          continue;
+
+        double Bound = Tables[0].getBoundWith(C, i, Budget);
+
+        for (unsigned k = 1; k < NumScales; k++)
+          Bound = std::min(Bound, Tables[k].getBoundWith(C, i, Budget));
+
+        if (Bound >= Best.Speedup + 0.5)
+          Keep.push_back(i);
+      }
+
+      SelectionCandidates Sub;
+      Selection SubBest;
+
+      // Search the best candidates first, the bounds of what is left then drop fastest.
+      C.getSubset(Keep, Sub);
+      getOrderByRatio(Sub, Order);
+
+      for (unsigned j = 0; j < Order.size(); j++)
+        Order[j] = Keep[Order[j]];
+
+      C.getSubset(Order, Sub);
+      SubBest.Optimal = true;
+      SubBest.Speedup = Best.Speedup;
+
+      search(Sub, Budget, MaxNodes, SubBest);
+
+      Best.Optimal = SubBest.Optimal;
+      Best.Nodes = SubBest.Nodes;
+
+      // The first selection was not improved on.
+      if (SubBest.Regions.empty())
+        return;
+
+      for (unsigned j = 0; j < SubBest.Regions.size(); j++)
+        SubBest.Regions[j] = Order[SubBest.Regions[j]];
+
+      std::sort(SubBest.Regions.begin(), SubBest.Regions.end());
+
+      record(C, SubBest.Regions, Best);
+    }
+  };
+
+
+  // Counts over the positions 0 ... n-1 of the candidates (Fenwick tree):
+  // add to a position, sum a prefix, both in O(log n).
+  class PositionCounts {
+
+    std::vector<int32_t> Tree;
+
+  public:
+    PositionCounts(unsigned N) : Tree(N + 1, 0) {}
+
+    void add(unsigned i, int32_t Delta) {
+
+      for (i++; i < Tree.size(); i += i & -i)
+        Tree[i] += Delta;
+    }
+
+    // @return  The sum of the positions 0 ... i-1.
+    int32_t getPrefix(unsigned i) const {
+
+      int32_t Sum = 0;
+
+      for (; i > 0; i -= i & -i)
+        Sum += Tree[i];
+
+      return Sum;
+    }
+  };
+
+  // Greedy selection: the candidates are picked from a binary heap, best
+  // Score first, as long as they fit in the budget.
+  //
+  // Picking a candidate rules out its enclosing and nested Regions. They are
+  // not removed from the heap but dropped when they come out of it (lazy
+  // invalidation): candidate i is nested in a picked one if a picked
+  // interval [k, End[k]) covers i, and encloses one if a picked position lies
+  // in [i+1, End[i]). Both are O(log n) queries, the whole selection
+  // O(n log n).
+  class GreedySelector {
+
+    const SelectionCandidates &C;
+    SelectionScore Score;
+
+    double getScore(unsigned i) const {
+
+      return Score == SS_Ratio ? getRatio(C, i) : static_cast<double>(C.Speedup[i]);
+    }
+
+  public:
+    GreedySelector(const SelectionCandidates &C, SelectionScore Score) : C(C), Score(Score) {}
+
+    void select(uint64_t Budget, Selection &Best) {
+
+      Best = Selection();
+
+      // Ties go to the outermost, first candidate.
+      typedef std::pair<double, unsigned> Entry;
+      std::vector<Entry> Heap;
+
+      for (unsigned i = 0; i < C.size(); i++)
+        if (C.Speedup[i] > 0 && C.Area[i] <= Budget)
+          Heap.push_back(Entry(getScore(i), i));
+
+      auto Worse = [](const Entry &A, const Entry &B) {
+        return A.first < B.first || (A.first == B.first && A.second > B.second);
+      };
+
+      std::make_heap(Heap.begin(), Heap.end(), Worse);
+
+      PositionCounts Picked(C.size()), Covered(C.size());
+
+      while (!Heap.empty()) {
+
+        unsigned i = Heap.front().second;
+        std::pop_heap(Heap.begin(), Heap.end(), Worse);
+        Heap.pop_back();
+
+        if (C.Area[i] > Budget - Best.Area || Covered.getPrefix(i + 1) > 0 ||
+            Picked.getPrefix(C.End[i]) > Picked.getPrefix(i + 1))
+          continue;
+
+        Best.Regions.push_back(i);
+        Best.Speedup += C.Speedup[i];
+        Best.Area    += C.Area[i];
+
+        Picked.add(i, 1);
+        Covered.add(i, 1);
+        Covered.add(C.End[i], -1);
+      }
+    }
+  };
+
+
+  // A point of the speedup / area Pareto frontier: the best selection found
+  // whose area, rounded up to the resolution, is Units.
+  struct ParetoPoint {
+
+    uint64_t Units;             // Area in units of the resolution, rounded up.
+    int64_t  Speedup;
+    uint64_t Area;              // Exact area in LUTs.
+    uint32_t Regions;
+  };
+
+  // Keep the points no other point beats, i.e. with fewer or as many Units
+  // and a larger or equal Speedup, in order of Units.
+  void pruneDominated(std::vector<ParetoPoint> &Points) {
+
+    std::sort(Points.begin(), Points.end(), [](const ParetoPoint &A, const ParetoPoint &B) {
+      return A.Units < B.Units || (A.Units == B.Units && (A.Speedup > B.Speedup ||
+                                   (A.Speedup == B.Speedup && A.Area < B.Area)));
+    });
+
+    unsigned Kept = 0;
+
+    for (unsigned j = 0; j < Points.size(); j++)
+      if (Kept == 0 || Points[j].Speedup > Points[Kept-1].Speedup)
+        Points[Kept++] = Points[j];
+
+    Points.resize(Kept);
+  }
+
+  // Replace A with the best selections made of one point of A and one of B,
+  // two frontiers of disjoint Regions, that fit in Budget. The best of every
+  // Units is kept in a table, then the dominated ones are dropped in one
+  // sweep: O(|A| |B|) plus the Units spanned.
+  void combineFrontiers(std::vector<ParetoPoint> &A, const std::vector<ParetoPoint> &B,
+                        uint64_t Budget, uint64_t Resolution) {
+
+    std::vector<ParetoPoint> Best(A.back().Units + B.back().Units + 1);
+    std::vector<bool> Found(Best.size(), false);
+
+    for (unsigned a = 0; a < A.size(); a++)
+      for (unsigned b = 0; b < B.size() && A[a].Area + B[b].Area <= Budget; b++) {
+
+        ParetoPoint P = { 0, A[a].Speedup + B[b].Speedup, A[a].Area + B[b].Area, A[a].Regions + B[b].Regions };
+        P.Units = (P.Area + Resolution - 1) / Resolution;
+
+        if (!Found[P.Units] || P.Speedup > Best[P.Units].Speedup ||
+            (P.Speedup == Best[P.Units].Speedup && P.Area < Best[P.Units].Area)) {
+          Best[P.Units] = P;
+          Found[P.Units] = true;
+        }
+      }
+
+    A.clear();
+
+    for (unsigned u = 0; u < Best.size(); u++)
+      if (Found[u] && (A.empty() || Best[u].Speedup > A.back().Speedup))
+        A.push_back(Best[u]);
+  }
+
+  // The Pareto frontier of the speedup against the area of the selections
+  // that fit in Budget, in one tree knapsack pass over the Region forest.
+  //
+  // A frontier keeps the best selection of every area rounded up to a
+  // multiple of Resolution, so it holds at most Budget / Resolution + 2
+  // points. Going up the forest in reverse pre-order, the frontier of a
+  // candidate is that of its nested Regions combined, plus the candidate
+  // alone; the frontiers of the top level candidates are combined last.
+  // With Resolution 1 the frontier is exact. Otherwise a selection can be
+  // lost to one of the same rounded area that is better but larger, so the
+  // frontier is a close lower bound; every point of it is a real selection.
+  void getParetoFrontier(const SelectionCandidates &C, uint64_t Budget, uint64_t Resolution,
+                         std::vector<ParetoPoint> &Frontier) {
+
+    unsigned N = C.size();
+    const ParetoPoint Empty = { 0, 0, 0, 0 };
+
+    // Frontiers[i] is the combination of the frontiers of the children of i
+    // done so far, Frontiers[N] that of the top level candidates.
+    std::vector<std::vector<ParetoPoint> > Frontiers(N + 1);
+    Frontiers[N].push_back(Empty);
+
+    for (unsigned i = N; i-- > 0; ) {
+
+      std::vector<ParetoPoint> &F = Frontiers[i];
+
+      if (F.empty())
+        F.push_back(Empty);
+
+      if (C.Speedup[i] > 0 && C.Area[i] <= Budget) {
+        ParetoPoint P = { (C.Area[i] + Resolution - 1) / Resolution, C.Speedup[i], C.Area[i], 1 };
+        F.push_back(P);
+        pruneDominated(F);
+      }
+
+      std::vector<ParetoPoint> &Up = Frontiers[C.Parent[i] < 0 ? N : C.Parent[i]];
+
+      if (Up.empty())
+        Up.swap(F);
+      else
+        combineFrontiers(Up, F, Budget, Resolution);
+
+      std::vector<ParetoPoint>().swap(F);
+    }
+
+    Frontier.swap(Frontiers[N]);
+  }
+
+} // End of anonymous namespace
+
+#endif
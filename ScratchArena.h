@@ -0,0 +1,207 @@
+//===---------------------------- ScratchArena.h ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Bump allocation for the scratch storage of the costing routines of
+// RegionGraph.h, i.e. the vectors a Region or a BB needs while it is costed
+// and drops right after.
+//
+// Every thread has its own ScratchArena. A ScratchScope marks it and, when
+// it goes out of scope, releases everything allocated since, keeping the
+// memory for the next Region or BB. Checking and costing a Region allocate
+// only from the arena, so once it has grown to what the largest Region
+// needs they make no heap allocations at all; getHeapAllocations counts
+// those of the arena. What is kept of a Region, its name, results and
+// output text, is allocated on the heap and not counted.
+//
+// The arenas are owned by a list rather than by their threads, so that the
+// pass frees them at a point of its choosing, with destroyAll once its
+// ThreadPool has joined, instead of whenever each thread happens to exit.
+// A thread only keeps a pointer to its arena.
+//
+// ScratchVector<T> is a std::vector on the arena of its thread. It must not
+// outlive the innermost ScratchScope that was open when it allocated, nor
+// grow while an inner ScratchScope is open.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef REGIONSEEKER_SCRATCHARENA_H
+#define REGIONSEEKER_SCRATCHARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+class ScratchArena {
+
+  struct Chunk {
+    char *Data;
+    size_t Size;
+  };
+
+  std::vector<Chunk> Chunks;    // Kept when released, for the next allocations.
+  size_t Current;               // The Chunk allocated from.
+  size_t Used;                  // Bytes used in Chunks[Current].
+  uint64_t HeapAllocations;
+
+  ScratchArena(const ScratchArena &) = delete;
+  ScratchArena &operator=(const ScratchArena &) = delete;
+
+public:
+  struct Mark {
+    size_t Chunk;
+    size_t Used;
+  };
+
+  ScratchArena() : Current(0), Used(0), HeapAllocations(0) {}
+
+  ~ScratchArena() {
+
+    for (size_t i = 0; i < Chunks.size(); i++)
+      ::operator delete(Chunks[i].Data);
+  }
+
+  // The arena of the calling thread, created on first use.
+  static ScratchArena &get() {
+
+    ScratchArena *&Arena = getOfThread();
+
+    if (!Arena) {
+      Arena = new ScratchArena();
+      std::lock_guard<std::mutex> Lock(getListMutex());
+      getList().push_back(Arena);
+    }
+
+    return *Arena;
+  }
+
+  // Free the arenas of all the threads. Only once no ScratchScope is open on
+  // any thread, e.g. after the ThreadPool that costed has joined. The calling
+  // thread gets a new arena on its next get. Any other thread still alive
+  // keeps a dangling pointer to its freed arena until it exits, so it must
+  // not call get again.
+  static void destroyAll() {
+
+    std::lock_guard<std::mutex> Lock(getListMutex());
+    std::vector<ScratchArena *> &List = getList();
+
+    for (size_t i = 0; i < List.size(); i++)
+      delete List[i];
+
+    List.clear();
+    getOfThread() = nullptr;
+  }
+
+  // @param  Align  A power of 2, at most that of ::operator new.
+  void *allocate(size_t Bytes, size_t Align) {
+
+    for (;;) {
+
+      if (Current < Chunks.size()) {
+
+        size_t Start = (Used + Align - 1) & ~(Align - 1);
+
+        if (Start + Bytes <= Chunks[Current].Size) {
+          Used = Start + Bytes;
+          return Chunks[Current].Data + Start;
+        }
+
+        // Try the Chunks kept from earlier allocations before a new one.
+        if (Current + 1 < Chunks.size()) {
+          Current++;
+          Used = 0;
+          continue;
+        }
+      }
+
+      Chunk New;
+      New.Size = std::max<size_t>(Bytes, Chunks.empty() ? 1 << 16 : 2 * Chunks.back().Size);
+      New.Data = static_cast<char *>(::operator new(New.Size));
+      HeapAllocations++;
+      Chunks.push_back(New);
+      Current = Chunks.size() - 1;
+      Used = 0;
+    }
+  }
+
+  Mark mark() const {
+
+    Mark M = { Current, Used };
+    return M;
+  }
+
+  // Free everything allocated since M, for reuse.
+  void release(const Mark &M) {
+
+    Current = M.Chunk;
+    Used = M.Used;
+  }
+
+  // @return  The number of Chunks allocated on the heap so far.
+  uint64_t getHeapAllocations() const { return HeapAllocations; }
+
+private:
+  // A pointer, so nothing has to be destroyed when the thread ends.
+  static ScratchArena *&getOfThread() {
+
+    static thread_local ScratchArena *Arena = nullptr;
+    return Arena;
+  }
+
+  static std::vector<ScratchArena *> &getList() {
+
+    static std::vector<ScratchArena *> List;
+    return List;
+  }
+
+  static std::mutex &getListMutex() {
+
+    static std::mutex Mutex;
+    return Mutex;
+  }
+};
+
+// Releases what the arena of the calling thread allocates during its lifetime.
+class ScratchScope {
+
+  ScratchArena &Arena;
+  ScratchArena::Mark Start;
+
+  ScratchScope(const ScratchScope &) = delete;
+  ScratchScope &operator=(const ScratchScope &) = delete;
+
+public:
+  ScratchScope() : Arena(ScratchArena::get()), Start(Arena.mark()) {}
+  ~ScratchScope() { Arena.release(Start); }
+};
+
+template <typename T>
+struct ScratchAllocator {
+
+  typedef T value_type;
+
+  ScratchAllocator() {}
+  template <typename U> ScratchAllocator(const ScratchAllocator<U> &) {}
+
+  T *allocate(size_t N) { return static_cast<T *>(ScratchArena::get().allocate(N * sizeof(T), alignof(T))); }
+  void deallocate(T *, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const ScratchAllocator<T> &, const ScratchAllocator<U> &) { return true; }
+
+template <typename T, typename U>
+bool operator!=(const ScratchAllocator<T> &, const ScratchAllocator<U> &) { return false; }
+
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T> >;
+
+#endif // REGIONSEEKER_SCRATCHARENA_H
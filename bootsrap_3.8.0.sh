@@ -34,7 +34,12 @@ cmake --build .
 # Copy the folder containing the IdentifyRegions pass to LLVM source tree.
 cd ../..
 cp -r IdentifyRegions llvm-RS-3.8.0/llvm-3.8.0.src/lib/Transforms/.
+cp Identify.h CostModel.h RegionGraph.h RegionResults.h ScratchArena.h llvm-RS-3.8.0/llvm-3.8.0.src/lib/Transforms/.
 sed -i.bak 's/^\(PARALLEL_DIRS = .*\)/\1 IdentifyRegions/' llvm-RS-3.8.0/llvm-3.8.0.src/lib/Transforms/Makefile
 echo "add_subdirectory(IdentifyRegions)" >> llvm-RS-3.8.0/llvm-3.8.0.src/lib/Transforms/CMakeLists.txt 
 
+# Copy the RegionCost and RegionSelect tools to the LLVM tools, tools/CMakeLists.txt picks up their directories.
+cp -r RegionCost RegionSelect llvm-RS-3.8.0/llvm-3.8.0.src/tools/.
+cp CostModel.h RegionGraph.h RegionResults.h RegionSelection.h ScratchArena.h llvm-RS-3.8.0/llvm-3.8.0.src/tools/.
+
 rm cfe-3.8.0.src.tar.xz  llvm-3.8.0.src.tar.xz